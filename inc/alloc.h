@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - alloc.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ALLOC_H
+#define _ALLOC_H
+
+
+/////////////////////////////////////////////////////////////
+// ALLOC DESCRIPTION
+//
+// The allocator struct is a small interface that lets the array and
+// heap structs obtain memory for the elements they own from somewhere
+// other than malloc and free. Passing a NULL allocator anywhere one is
+// accepted selects the standard library.
+//
+// Two allocators are provided. The arena hands out memory by bumping
+// a pointer through large blocks and releases everything at once
+// with arena_free or arena_reset, individual frees being ignored. The
+// slab hands out fixed size objects and keeps released objects on a
+// free list so they can be reused without touching malloc.
+
+
+/////////////////////////////////////////////////////////////
+// ALLOC TYPES
+//
+
+#define ALLOC_ALIGN 16
+
+typedef void*(*alloc_func)(void*, size_t);
+typedef void(*release_func)(void*, void*);
+
+struct allocator {
+  alloc_func   alloc;
+  release_func release;
+  void         *ctx;
+};
+
+struct arena_block {
+  struct arena_block *next;
+  size_t             size;
+  size_t             used;
+  _Alignas(ALLOC_ALIGN) char data[];
+};
+
+struct arena {
+  struct arena_block *head;
+  size_t             block_size;
+  struct allocator   allocator;
+};
+
+struct slab_block {
+  struct slab_block *next;
+  _Alignas(ALLOC_ALIGN) char data[];
+};
+
+struct slab {
+  struct slab_block *blocks;
+  void              *free_list;
+  size_t            size;
+  size_t            count;
+  struct allocator  allocator;
+};
+
+
+/////////////////////////////////////////////////////////////
+// ALLOC FUNCTION DECLARATION
+//
+
+// Functions used by the structs to allocate through an allocator
+void*             allocator_alloc(struct allocator *alloc, size_t size);
+void              allocator_release(struct allocator *alloc, void *ptr);
+
+// Functions to create, use and free arenas
+struct arena*     arena_create(size_t block_size);
+void              arena_free(struct arena *arena);
+void              arena_reset(struct arena *arena);
+void*             arena_alloc(struct arena *arena, size_t size);
+struct allocator* arena_allocator(struct arena *arena);
+
+// Functions to create, use and free slabs
+struct slab*      slab_create(size_t size, size_t count);
+void              slab_free(struct slab *slab);
+void*             slab_alloc(struct slab *slab);
+void              slab_release(struct slab *slab, void *ptr);
+struct allocator* slab_allocator(struct slab *slab);
+
+#endif // _ALLOC_H
@@ -35,24 +35,118 @@
 // The dynamic array takes ownership of memory meaning that it will
 // copy data from the stack to heap and is responsible for freeing
 // this memory when it is no longer required.
+//
+// Arrays created with array_create_inline store each element by
+// value in a single contiguous buffer with a fixed stride rather
+// than as a pointer to a separate heap block. In this mode
+// array_get returns a pointer into that buffer which remains valid
+// until the array is next modified.
+// Payloads of sizeof(void*) bytes or less, such as ids, chars and
+// ints, are best kept in an inline array with a stride of
+// sizeof(void*): each slot then holds the payload where a pointer
+// array would hold the address of a separate block, and nothing is
+// allocated per element.
+//
+// When an array runs out of room its capacity grows geometrically by
+// the factor given to array_set_growth (ARRAY_GROWTH by default), so
+// repeated appends cost amortized constant time.
+//
+// Pointer arrays created with array_create_alloc copy their elements
+// into memory obtained from the given allocator. Elements popped from
+// such an array must be released through the same allocator. Inline
+// arrays ignore the allocator: their elements live in the array's own
+// buffer, which grows with realloc and so always comes from malloc.
+//
+// The elements of an array start at head and wrap around the end of
+// the buffer, which makes it a ring buffer. Items can be pushed and
+// popped at either end in constant time and the array keeps its
+// capacity when it empties. Inserting or removing in the middle of a
+// wrapped array first straightens it out with array_linearize.
+//
+// Blocks the caller has already allocated can be handed to a pointer
+// array without a copy using array_adopt or array_push_ptr, after
+// which the array owns them. Arrays created with array_create_view
+// never own their elements: they store the caller's pointers as given
+// and array_free leaves them alone. array_copy_from copies inline
+// elements by value but shares pointer elements, so pointer arrays can
+// only be copied into a view.
+//
+// array_sort is a stable merge sort split across up to nthreads
+// threads. The comparator is given the elements as array_get returns
+// them, so pointer arrays compare the data pointed to while inline
+// arrays compare the elements in place and move them by value. Each
+// thread sorts a chunk of at least ARRAY_SORT_MIN elements and the
+// chunks are then merged in rounds, each merge split evenly between
+// the threads by binary search.
+//
+// array_parallel_for_each calls func on every element, passing ctx
+// along, split across up to nthreads threads of the shared pool (see
+// pool.h). The elements are cut into chunks of at least
+// ARRAY_PARALLEL_MIN elements, up to ARRAY_PARALLEL_CHUNKS per thread
+// so that a thread which finishes early can take another. Calls on
+// different elements run at once and in no set order, so func must
+// only touch its own element and whatever in ctx it guards itself.
+// The shared pool runs one call at a time, so while another thread's
+// parallel call holds it, or when called from inside a parallel task,
+// the call runs serially on the calling thread instead.
+//
+// array_parallel_reduce maps every element into a partial result of
+// size bytes per chunk, each starting as a copy of the value in
+// result, then folds the partials into result in element order with
+// reduce. reduce must be associative and result must start as its
+// identity, eg. zero for a sum, so the answer does not depend on how
+// the elements were chunked.
+//
+// Arrays loaded with array_load or heap_load keep their elements in a
+// file mapping owned by a store (A_MAPPED). See store.h.
+//
+// When built with -DSTATS_BUILD each array counts its allocations,
+// reallocs, bytes copied and shifted elements for array_stats.
 
 
 /////////////////////////////////////////////////////////////
 // ARRAY TYPES
 //
 
+#define ARRAY_GROWTH   2.0
+#define ARRAY_MIN_GROW 5
+
+#define ARRAY_SORT_RUN     16   // Elements insertion sorted before merging
+#define ARRAY_SORT_MIN     4096 // Fewest elements given to a sort thread
+#define ARRAY_SORT_THREADS 64
+
+#define ARRAY_PARALLEL_MIN    1024 // Fewest elements in a parallel chunk
+#define ARRAY_PARALLEL_CHUNKS 4    // Chunks handed out per thread
+
 struct array {
   void   **data;
   size_t capacity;
   size_t count;
+  size_t head;
+  size_t stride;
+  int    flags;
+  double growth;
+  struct allocator *alloc;
+#ifdef STATS_BUILD
+  struct struct_stats stats;
+#endif
 };
 
 typedef void(*array_func)(void*);
+typedef int(*array_cmp)(const void*, const void*);
+typedef void(*array_ctx_func)(void *data, void *ctx);
+typedef void(*array_map_func)(void *acc, void *data, void *ctx);
+typedef void(*array_reduce_func)(void *acc, void *partial, void *ctx);
 
 enum array_e {
   A_ERR = 0, A_OK
 };
 
+enum array_flag {
+  A_VIEW   = 1 << 0,
+  A_MAPPED = 1 << 1  // The buffer lies in a store mapping
+};
+
 
 /////////////////////////////////////////////////////////////
 // ARRAY FUNCTION DECLARATION
@@ -60,15 +154,29 @@ enum array_e {
 
 // Functions to create and free memory allocated to arrays
 struct array* array_create(size_t size);
+struct array* array_create_inline(size_t size, size_t stride);
+struct array* array_create_view(size_t size);
+struct array* array_create_alloc(size_t size, size_t stride, struct allocator *alloc);
 void          array_free(struct array *array);
 
 // Functions to add to, remove from and manipulate arrays
 int           array_resize(struct array *array, size_t size);
+int           array_reserve(struct array *array, size_t size);
+int           array_linearize(struct array *array);
+int           array_set_growth(struct array *array, double factor);
 int           array_insert(struct array *array, size_t pos, void *data, size_t size);
+int           array_insert_range(struct array *array, size_t pos, void *data, size_t count, size_t size);
 int           array_append(struct array *array, void *data, size_t size);
+int           array_prepend(struct array *array, void *data, size_t size);
+int           array_adopt(struct array *array, size_t pos, void *data);
+int           array_push_ptr(struct array *array, void *data);
+int           array_append_n(struct array *array, void *data, size_t count, size_t size);
 int           array_set(struct array *array, size_t pos, void *data, size_t size);
-void           array_copy_from(struct array *dest, struct array *src, size_t index);
+int           array_copy_from(struct array *dest, struct array *src, size_t index);
 void          array_for_each(struct array *array, array_func func);
+int           array_sort(struct array *array, array_cmp cmp, size_t nthreads);
+int           array_parallel_for_each(struct array *array, array_ctx_func func, void *ctx, size_t nthreads);
+int           array_parallel_reduce(struct array *array, array_map_func map, array_reduce_func reduce, void *ctx, void *result, size_t size, size_t nthreads);
 
 // Functions to obtain data from the array
 void*         array_front(struct array *array);
@@ -78,6 +186,7 @@ void*         array_pop_beg(struct array *array);
 void*         array_pop_end(struct array *array);
 void*         array_pop_pos(struct array *array, size_t pos);
 size_t        array_size(struct array *array);
+int           array_stats(struct array *array, struct struct_stats *stats);
 
 // Functions to print to screen
 void          array_print_as_string(struct array *array);
@@ -29,24 +29,128 @@
 // HEAP DESCRIPTION
 //
 // The heap struct is a data structure that takes the form of a binary
-// tree. The heap structure can specify either min or max heap by use
+// tree, or a d-ary tree when created with heap_create_ary. Wider trees
+// of 4 or 8 children are shallower and keep the children of a node on
+// a single cache line which makes popping from large heaps cheaper.
+// The heap structure can specify either min or max heap by use
 // of the heap_e enumeration.
 //
 // For min-heaps to pop the parent node guarentee's a value either
 // smaller than or equal to it's children. For max-heaps the value is
 // either greater than or equal to it's children.
 //
+// A MINMAXHEAP is a binary heap whose levels alternate between
+// minimum levels, starting with the root, and maximum levels. An elem
+// on a minimum level is no greater than any elem below it and one on
+// a maximum level no smaller, so the smallest elem is the root and the
+// largest one of its two children. heap_peek_min and heap_peek_max
+// find either end in O(1) and heap_pop_min and heap_pop_max remove it
+// in O(log n), which serves a double ended priority queue from one
+// array. heap_pop and heap_pop_into pop the minimum. Min-max heaps
+// cannot be created with any other arity.
+//
+// heap_peek_min and heap_pop_min also work on a MINHEAP, and
+// heap_peek_max and heap_pop_max on a MAXHEAP. Asking a heap for the
+// end it does not keep at its root fails unless it holds one elem.
+//
 // The min-heap uses the array struct and as such will own data
 // contained within until it is popped from the heap. When items are
 // popped from the heap they should be subsequently freed.
+//
+// The elem records themselves are stored by value in an inline array
+// so adding to the heap only allocates the payload copy. heap_pop_into
+// copies the popped elem into caller storage, leaving only the payload
+// to be freed, whereas heap_pop returns the elem in its own allocation.
+// heap_pop_with does the same for any pop_into style function, and the
+// other queues build their own pop on it.
+//
+// Each elem's value is mirrored in a dense keys array kept parallel to
+// the elems so that comparisons while sifting only touch contiguous
+// priorities rather than loading them out of the elem records.
+//
+// A heap can be built in O(n) from an existing array of elems with
+// heap_from_array, which adopts the array, or from a buffer of elems
+// with heap_from_elems. In both cases the heap takes ownership of the
+// payloads which must come from the array's allocator.
+//
+// heap_add_handle returns a handle for the added elem which stays
+// valid until the elem leaves the heap. The handle can be used to
+// change the elem's priority with heap_update_key or to remove it with
+// heap_remove. Once any handle has been asked for the heap tracks the
+// position of every elem, which makes each move slightly dearer.
+//
+// When built with -DSTATS_BUILD heap_stats reports the heap's payload
+// allocations and sift depths along with the counters of its arrays.
+//
+// A heap created with heap_create_bounded holds at most bound elems
+// offered with heap_offer, which keeps the bound elems furthest from
+// the root: a bounded MINHEAP keeps the largest values seen and a
+// bounded MAXHEAP the smallest. Once full an offered elem that beats
+// the root replaces it in place and heap_offer returns H_OK, while one
+// that does not is dropped and heap_offer returns H_REJECT, leaving
+// H_ERR for a failed allocation. Payload blocks of a bounded heap are
+// rounded up to a power of two of at least ALLOC_ALIGN bytes and the
+// root's block is reused by any payload of the same rounded size, so
+// once the heap first fills a stream of payloads allocates nothing
+// for as long as their sizes stay within one power of two.
+// heap_drain_sorted then empties the heap into a buffer of elems, the
+// best kept elem first. heap_add ignores the bound and bounded heaps
+// cannot hand out handles or be merged.
+//
+// heap_add_n copies a batch of elems in behind the heap and restores
+// it once, sifting each new elem up when the batch is small next to
+// the heap and rebuilding bottom up when it is not. Either the whole
+// batch is added or none of it is, and heaps tracking handles refuse
+// batches since there would be no handles to give back. heap_pop_n pops up
+// to count elems into a caller buffer, root first. Each pop sinks the
+// hole left by the root straight to a leaf and lifts the last elem up
+// into it, which takes about half the comparisons of a full sift.
+//
+// heap_merge moves every elem of one heap into another, leaving the
+// source empty, in O(n) by rebuilding or by sifting the new elems up
+// when there are few of them. Heaps tracking handles or created with a
+// bound cannot be merged.
+// For merges in constant time see the pairing heap in pheap.h.
+//
+// Heaps created with heap_create_small (H_SMALL) keep any payload of
+// sizeof(void*) bytes or less in the data field of its elem rather
+// than in a copy of its own, so heaps of ids, chars and ints allocate
+// nothing per elem. elem->size tells the two apart: heap_elem_data
+// returns the payload of an elem of either kind, heap_free and
+// heap_release_elem release only the copies and heap_free_elem must
+// not be used on elems popped from such a heap.
+//
+// heap_parallel_for_each calls func on every elem, in no set order,
+// across up to nthreads threads as array_parallel_for_each does, and
+// likewise runs serially when the shared pool is busy. func is given
+// the elem itself and must not change its value.
+//
+// Histograms attached with heap_attach_hist record the latency of
+// heap_add and heap_pop calls, and of each elem popped by heap_pop_n,
+// heap_drain_sorted, heap_pop_min and heap_pop_max. heap_add_n and
+// heap_merge restore the heap once per batch, so they are not timed.
+// The heap does not own the histograms.
+//
+// Heaps created with heap_create_alloc obtain their payload copies
+// from the given allocator, so a slab sized for the payloads will do.
+// The elem record returned by heap_pop always comes from malloc. Items
+// popped from such a heap are released with heap_release_elem rather
+// than heap_free_elem.
 
 
 /////////////////////////////////////////////////////////////
 // HEAP TYPES
 //
 
+#define HEAP_ARITY 2
+#define HEAP_NONE  ((size_t)-1)
+
 enum heap_e {
-  H_ERR = 0, H_OK, MINHEAP, MAXHEAP
+  H_ERR = 0, H_OK, MINHEAP, MAXHEAP, MINMAXHEAP, H_REJECT
+};
+
+enum heap_flag {
+  H_SMALL = 1 << 0  // Payloads that fit a pointer are kept in the elem
 };
 
 struct elem {
@@ -57,10 +161,25 @@ struct elem {
 
 struct heap {
   struct array *array;
+  struct array *keys;
+  struct array *handles;
+  struct array *slots;
+  struct array *spare;
   enum heap_e type;
+  size_t arity;
+  size_t bound;
+  int flags;
+  struct allocator *alloc;
+  struct hist *add_hist;
+  struct hist *pop_hist;
+#ifdef STATS_BUILD
+  struct struct_stats stats;
+#endif
 };
 
 typedef void(*heap_func)(void*);
+typedef void(*heap_ctx_func)(void *elem, void *ctx);
+typedef int(*heap_pop_func)(void *source, struct elem *elem);
 
 
 /////////////////////////////////////////////////////////////
@@ -69,21 +188,48 @@ typedef void(*heap_func)(void*);
 
 // Functions to create and free memory allocated to heaps
 struct heap* heap_create(int type);
+struct heap* heap_create_alloc(int type, struct allocator *alloc);
+struct heap* heap_create_ary(int type, size_t arity, struct allocator *alloc);
+struct heap* heap_create_bounded(int type, size_t bound);
+struct heap* heap_create_small(int type);
+struct heap* heap_from_array(int type, struct array *array);
+struct heap* heap_from_elems(int type, struct elem *elems, size_t count);
 void         heap_free(struct heap *heap);
 void         heap_free_elem(struct elem *elem);
+void         heap_release_elem(struct heap *heap, struct elem *elem);
+struct elem* heap_pop_with(heap_pop_func pop, void *source);
 
 // Functions to add items to and manipulate heaps
 int          heap_add(struct heap *heap, void *data, size_t value, size_t size);
+int          heap_add_handle(struct heap *heap, void *data, size_t value, size_t size, size_t *handle);
+int          heap_add_n(struct heap *heap, struct elem *elems, size_t count);
+int          heap_update_key(struct heap *heap, size_t handle, size_t value);
+int          heap_remove(struct heap *heap, size_t handle, struct elem *elem);
+int          heap_offer(struct heap *heap, void *data, size_t value, size_t size);
 int          heap_swap(struct heap *heap, size_t elem1, size_t elem2);
+int          heap_build(struct heap *heap);
+int          heap_merge(struct heap *dst, struct heap *src);
 void         heap_heapify_up(struct heap *heap, size_t index);
 void         heap_heapify_down(struct heap *heap, size_t index);
 void         heap_for_each(struct heap *heap, heap_func func);
+int          heap_parallel_for_each(struct heap *heap, heap_ctx_func func, void *ctx, size_t nthreads);
 void         heap_print(struct heap *heap);
 
 // Functions to obtain values from the heap
 struct elem* heap_pop(struct heap *heap);
+int          heap_pop_into(struct heap *heap, struct elem *elem);
+int          heap_pop_min(struct heap *heap, struct elem *elem);
+int          heap_pop_max(struct heap *heap, struct elem *elem);
+struct elem* heap_peek_min(struct heap *heap);
+struct elem* heap_peek_max(struct heap *heap);
+size_t       heap_pop_n(struct heap *heap, struct elem *elems, size_t count);
+size_t       heap_drain_sorted(struct heap *heap, struct elem *elems);
 size_t       heap_get_value(struct heap *heap, size_t index);
+void*        heap_elem_data(struct heap *heap, struct elem *elem);
+size_t       heap_handle_index(struct heap *heap, size_t handle);
 size_t       heap_size(struct heap *heap);
+int          heap_stats(struct heap *heap, struct struct_stats *stats);
+void         heap_attach_hist(struct heap *heap, struct hist *add_hist, struct hist *pop_hist);
 
 
 #endif // _HEAP_H
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - hist.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _HIST_H
+#define _HIST_H
+
+
+/////////////////////////////////////////////////////////////
+// HIST DESCRIPTION
+//
+// The hist struct is a log-bucketed latency histogram in the style of
+// HDR histograms. Each power of two is split into HIST_SUB linear
+// sub-buckets so recorded values keep a relative precision of about
+// 1 / HIST_SUB across the whole range while the histogram stays a
+// fixed size array of counts.
+//
+// Latencies are measured in ticks from hist_now, which reads the time
+// stamp counter on x86 and the monotonic clock in nanoseconds
+// elsewhere. hist_print converts ticks to nanoseconds. A histogram
+// created with a sample rate of N only times every Nth call passed to
+// hist_sample which keeps the cost low enough to leave on.
+//
+// Histograms can be attached to a heap with heap_attach_hist to time
+// heap_add and heap_pop.
+
+
+/////////////////////////////////////////////////////////////
+// HIST TYPES
+//
+
+#define HIST_SUB_BITS 4
+#define HIST_SUB      (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS  ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+struct hist {
+  size_t counts[HIST_BUCKETS];
+  size_t total;
+  size_t max;
+  size_t sample;
+  size_t calls;
+};
+
+
+/////////////////////////////////////////////////////////////
+// HIST FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to histograms
+struct hist* hist_create(size_t sample);
+void         hist_free(struct hist *hist);
+void         hist_clear(struct hist *hist);
+
+// Functions to time and record values
+size_t       hist_now();
+int          hist_sample(struct hist *hist);
+void         hist_record(struct hist *hist, size_t value);
+
+// Functions to obtain and print percentiles
+size_t       hist_percentile(struct hist *hist, double percent);
+size_t       hist_count(struct hist *hist);
+double       hist_tick_ns();
+void         hist_print(struct hist *hist, const char *name);
+
+#endif // _HIST_H
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pheap.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _PHEAP_H
+#define _PHEAP_H
+
+
+/////////////////////////////////////////////////////////////
+// PHEAP DESCRIPTION
+//
+// The pheap struct is a pairing heap: a tree of nodes in which every
+// node has a value either smaller than or equal to (min-heaps) or
+// greater than or equal to (max-heaps) the values of its children.
+// Adding an elem and merging two heaps only link one root under the
+// other so both take O(1). Popping melds the children of the root in
+// two passes, which costs amortized O(log n).
+//
+// pheap_merge moves every elem of the source heap into the
+// destination without copying or visiting them, leaving the source
+// empty but still usable. Both heaps must be of the same type.
+//
+// Nodes are carved from an arena and recycled through a free list
+// rather than being allocated one by one. Each heap keeps its arenas
+// on a chain, and a merge splices the source's chain and free list
+// onto the destination's in O(1), so the nodes stay valid for as long
+// as the destination lives.
+//
+// As with the heap the payload of each elem is copied in when it is
+// added and popped elems are owned by the caller, to be freed with
+// heap_free_elem.
+//
+// The pheap struct requires the alloc and heap structs.
+
+
+/////////////////////////////////////////////////////////////
+// PHEAP TYPES
+//
+
+#define PHEAP_BLOCK 256 // Nodes carved from each arena block
+
+struct pnode {
+  struct elem  elem;
+  struct pnode *child;
+  struct pnode *sibling;
+};
+
+struct parena {
+  struct arena  *arena;
+  struct parena *next;  // Carved from the arena it links
+};
+
+struct pheap {
+  struct pnode *root;
+  struct pnode *spare;
+  struct pnode *spare_tail;
+  struct parena *arenas;
+  struct parena *arenas_tail;
+  enum heap_e  type;
+  size_t       count;
+};
+
+
+/////////////////////////////////////////////////////////////
+// PHEAP FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to pairing heaps
+struct pheap* pheap_create(int type);
+void          pheap_free(struct pheap *pheap);
+
+// Functions to add items to and combine pairing heaps
+int           pheap_add(struct pheap *pheap, void *data, size_t value, size_t size);
+int           pheap_merge(struct pheap *dst, struct pheap *src);
+
+// Functions to obtain values from pairing heaps
+struct elem*  pheap_pop(struct pheap *pheap);
+int           pheap_pop_into(struct pheap *pheap, struct elem *elem);
+size_t        pheap_get_value(struct pheap *pheap);
+size_t        pheap_size(struct pheap *pheap);
+
+
+#endif // _PHEAP_H
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pool.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _POOL_H
+#define _POOL_H
+
+
+/////////////////////////////////////////////////////////////
+// POOL DESCRIPTION
+//
+// The pool struct is a set of worker threads which are started once
+// and then reused for every job run on the pool, so that a parallel
+// loop does not pay for creating and joining its threads each time.
+//
+// pool_run splits a job into a number of chunks and calls the task
+// once for each chunk index on up to nthreads threads, the calling
+// thread being one of them. Chunks are handed out one at a time from
+// a shared counter, so threads that finish early take more chunks
+// rather than waiting on a slow one. pool_run returns once every chunk
+// has been run. A pool starts the workers it needs the first time a
+// job asks for them, up to POOL_THREADS - 1.
+//
+// A pool runs one job at a time. A job posted while another is running
+// on the same pool, such as from inside a task, runs all of its chunks
+// on the calling thread instead of waiting, so nested jobs cannot
+// deadlock.
+//
+// pool_shared returns a pool which is created on first use and backs
+// the parallel array and heap functions. pool_shared_free stops its
+// workers and frees it, and is registered with atexit so the workers
+// are joined when the process exits. It must not be called while a
+// parallel call is running; the next call to pool_shared creates a
+// new shared pool. As the shared pool runs one job at a time, two
+// threads making parallel calls at once do not wait on each other:
+// whichever finds the pool busy runs its call serially.
+
+
+/////////////////////////////////////////////////////////////
+// POOL TYPES
+//
+
+#define POOL_THREADS 64
+
+enum pool_e {
+  T_ERR = 0, T_OK
+};
+
+typedef void(*pool_task)(void *ctx, size_t chunk);
+
+struct pool {
+  pthread_mutex_t run;  // Held by the thread whose job is running
+  pthread_mutex_t lock;
+  pthread_cond_t  work; // Signalled when a job is posted
+  pthread_cond_t  done; // Signalled when the last worker leaves a job
+  pthread_t threads[POOL_THREADS];
+  size_t    count;
+  pool_task task;
+  void      *ctx;
+  size_t    chunks;
+  atomic_size_t next;   // Next chunk to hand out
+  size_t    seats;      // Workers wanted by the current job
+  size_t    joined;
+  size_t    active;
+  size_t    generation; // Bumped for every job posted
+  int       stop;
+};
+
+
+/////////////////////////////////////////////////////////////
+// POOL FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to pools
+struct pool* pool_create(size_t nthreads);
+struct pool* pool_shared(void);
+void         pool_free(struct pool *pool);
+void         pool_shared_free(void);
+
+// Functions to run jobs on pools
+int          pool_run(struct pool *pool, pool_task task, void *ctx, size_t chunks, size_t nthreads);
+size_t       pool_size(struct pool *pool);
+
+
+#endif // _POOL_H
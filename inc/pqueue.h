@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pqueue.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _PQUEUE_H
+#define _PQUEUE_H
+
+
+/////////////////////////////////////////////////////////////
+// PQUEUE DESCRIPTION
+//
+// The pqueue struct is a priority queue which can be shared between
+// threads. Rather than one heap behind one lock it is split into a
+// number of shards, each a heap with its own mutex padded onto its own
+// cache line, so that threads adding at the same time rarely meet.
+//
+// Adds go to a random shard, moving on to another when the chosen
+// shard is busy. How pops behave depends on the mode the queue was
+// created with:
+//
+// P_STRICT pops lock every shard and take the best root among them, so
+// each pop returns the highest priority elem in the queue exactly as
+// a single heap would. Pops are serialised; adds still scale.
+//
+// P_RELAXED pops follow the MultiQueue scheme. Two shards are picked
+// at random and the one whose root is better is popped, without
+// holding any other lock. The elem returned is close to the best rather
+// than the best, in exchange for pops that scale with the number of
+// threads. Around twice as many shards as threads works well.
+//
+// A pqueue with a single shard in P_STRICT mode is a heap behind one
+// global mutex. Popped elems are owned by the caller as with heap_pop.
+
+
+/////////////////////////////////////////////////////////////
+// PQUEUE TYPES
+//
+
+#define PQUEUE_LINE 64
+
+enum pqueue_e {
+  P_ERR = 0, P_OK, P_STRICT, P_RELAXED
+};
+
+struct shard {
+  _Alignas(PQUEUE_LINE) pthread_mutex_t lock;
+  struct heap *heap;
+  atomic_size_t size; // Published under the lock so that relaxed pops
+  atomic_size_t top;  // can compare shards without taking the lock
+};
+
+struct pqueue {
+  struct shard *shards;
+  size_t count;
+  enum heap_e type;
+  enum pqueue_e mode;
+};
+
+
+/////////////////////////////////////////////////////////////
+// PQUEUE FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to pqueues
+struct pqueue* pqueue_create(int type, size_t shards, int mode);
+void           pqueue_free(struct pqueue *queue);
+
+// Functions to add items to and obtain items from pqueues
+int            pqueue_add(struct pqueue *queue, void *data, size_t value, size_t size);
+struct elem*   pqueue_pop(struct pqueue *queue);
+int            pqueue_pop_into(struct pqueue *queue, struct elem *elem);
+size_t         pqueue_size(struct pqueue *queue);
+
+
+#endif // _PQUEUE_H
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - queue.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _QUEUE_H
+#define _QUEUE_H
+
+
+/////////////////////////////////////////////////////////////
+// QUEUE DESCRIPTION
+//
+// The queue struct is a bounded first in first out ring which any
+// number of threads may push to and pop from at once without locks.
+// It follows Dmitry Vyukov's MPMC design: each cell carries a sequence
+// number which tells a producer whether the cell is free for its
+// position and a consumer whether the cell has been filled, so each
+// push or pop costs a single compare and swap in the common case.
+//
+// The cells are held by value in an inline array created at a power
+// of two capacity which never grows. The producer and consumer
+// positions sit on cache lines of their own so that the two sides do
+// not invalidate each other's lines.
+//
+// The queue passes pointers and does not own them. queue_push fails
+// when the queue is full and queue_pop returns NULL when it is empty,
+// so NULL cannot be pushed.
+
+
+/////////////////////////////////////////////////////////////
+// QUEUE TYPES
+//
+
+#define QUEUE_LINE 64
+
+enum queue_e {
+  Q_ERR = 0, Q_OK
+};
+
+struct cell {
+  atomic_size_t seq;
+  void *data;
+};
+
+struct queue {
+  _Alignas(QUEUE_LINE) atomic_size_t tail; // Next position to push
+  _Alignas(QUEUE_LINE) atomic_size_t head; // Next position to pop
+  _Alignas(QUEUE_LINE) struct array *array;
+  struct cell *cells;
+  size_t mask;
+};
+
+
+/////////////////////////////////////////////////////////////
+// QUEUE FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to queues
+struct queue* queue_create(size_t size);
+void          queue_free(struct queue *queue);
+
+// Functions to pass items through queues
+int           queue_push(struct queue *queue, void *data);
+void*         queue_pop(struct queue *queue);
+size_t        queue_size(struct queue *queue);
+size_t        queue_capacity(struct queue *queue);
+
+
+#endif // _QUEUE_H
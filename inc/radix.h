@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - radix.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _RADIX_H
+#define _RADIX_H
+
+
+/////////////////////////////////////////////////////////////
+// RADIX DESCRIPTION
+//
+// The radix struct is a min priority queue for monotone workloads,
+// where no value added is ever smaller than the last value popped, as
+// in event simulation or shortest path searches.
+//
+// Elems are kept in buckets by the highest bit in which their value
+// differs from the last value popped. Bucket 0 holds values equal to
+// it and bucket b values that differ first at bit b - 1, so each
+// bucket covers a range twice as wide as the one before. Popping from
+// an empty bucket 0 finds the first bucket with elems, takes its
+// smallest value as the new last value and spreads its elems into the
+// lower buckets. An elem only ever moves down so it is moved at most
+// once per bit, giving amortized O(log C) operations where C is the
+// spread of the values.
+//
+// Each bucket is an inline array of elems so an elem costs one copy of
+// its payload, as with the heap. The functions mirror heap_add and
+// heap_pop and the elems popped are freed with heap_free_elem. Adding a
+// value smaller than the last one popped fails with R_ERR. The lower
+// buckets are grown before any elem moves, so if that fails the pop
+// fails with every elem left in place.
+//
+// The radix struct requires the array and heap structs.
+
+
+/////////////////////////////////////////////////////////////
+// RADIX TYPES
+//
+
+#define RADIX_BUCKETS (sizeof(size_t) * 8 + 1)
+
+enum radix_e {
+  R_ERR = 0, R_OK
+};
+
+struct radix {
+  struct array *buckets[RADIX_BUCKETS];
+  size_t last;
+  size_t count;
+};
+
+
+/////////////////////////////////////////////////////////////
+// RADIX FUNCTION DECLARATION
+//
+
+// Functions to create and free memory allocated to radix heaps
+struct radix* radix_create();
+void          radix_free(struct radix *radix);
+
+// Functions to add items to and obtain items from radix heaps
+int           radix_add(struct radix *radix, void *data, size_t value, size_t size);
+struct elem*  radix_pop(struct radix *radix);
+int           radix_pop_into(struct radix *radix, struct elem *elem);
+size_t        radix_get_value(struct radix *radix);
+size_t        radix_size(struct radix *radix);
+
+
+#endif // _RADIX_H
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - stats.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _STATS_H
+#define _STATS_H
+
+
+/////////////////////////////////////////////////////////////
+// STATS DESCRIPTION
+//
+// The struct_stats struct holds counters describing the work done by
+// an array or heap. Counting is only compiled in when the project is
+// built with -DSTATS_BUILD, otherwise the STATS macros expand to
+// nothing, the structs carry no counters and the stats functions
+// return an error with zeroed stats.
+//
+// Moves count the elements shifted by inserts and pops in the middle
+// of an array. Sift levels count the levels an elem travels in
+// heap_heapify_up and heap_heapify_down.
+
+
+/////////////////////////////////////////////////////////////
+// STATS TYPES
+//
+
+struct struct_stats {
+  size_t allocs;
+  size_t reallocs;
+  size_t bytes_copied;
+  size_t moves;
+  size_t sifts;
+  size_t sift_levels;
+  size_t max_sift_levels;
+};
+
+#ifdef STATS_BUILD
+#define STATS_ADD(obj, field, n) ((obj)->stats.field += (n))
+#define STATS_MAX(obj, field, n) \
+  ((obj)->stats.field = ((n) > (obj)->stats.field) ? (n) : (obj)->stats.field)
+#else
+#define STATS_ADD(obj, field, n) ((void)(n))
+#define STATS_MAX(obj, field, n) ((void)(n))
+#endif
+
+
+/////////////////////////////////////////////////////////////
+// STATS FUNCTION DECLARATION
+//
+
+// Functions to combine and clear counters
+void stats_merge(struct struct_stats *dest, struct struct_stats *src);
+void stats_clear(struct struct_stats *stats);
+
+#endif // _STATS_H
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - store.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _STORE_H
+#define _STORE_H
+
+
+/////////////////////////////////////////////////////////////
+// STORE DESCRIPTION
+//
+// The store functions save arrays and heaps to a binary file which can
+// later be mapped back into memory and used where it lies, rather than
+// being read and rebuilt one element at a time.
+//
+// Every file starts with a store_header giving the magic STORE_MAGIC,
+// the format version and the offsets of each section, which are
+// aligned to ALLOC_ALIGN. Inline arrays are written as their slots.
+// Pointer arrays and heaps also write the payload of every element,
+// with the element slots holding the offset of their payload in the
+// file. Heaps write their elems in heap order along with the dense
+// keys so no sifting is needed on load. The format is native: it is
+// only read back on a machine with the same word size and byte order.
+//
+// store_open maps a file privately and checks its header. array_load
+// and heap_load then return structs whose buffers are the mapping
+// itself, so the elements are never read in and rebuilt. Changes made
+// to a loaded struct are never written back to the file; a loaded
+// buffer is copied out to the heap the first time it has to grow.
+//
+// Pointer arrays and heaps are not quite used as they lie: their
+// slots hold payload offsets which the load turns back into pointers
+// in place, so that the structs work with the rest of the library
+// unchanged. Loading them is therefore O(n) in time and, as writing
+// to a private mapping copies the page, the slot pages of the file
+// (though not the payloads) end up in private memory. Inline arrays
+// need no fix-up and load in constant time without copying a page.
+// Offsets that point outside the payload section, or out of the order
+// they were written in, make the load fail. So do heap keys that no
+// longer match their elems and elems that are out of heap order.
+//
+// Payloads still in the mapping are owned by the store. Loaded structs
+// use the store's allocator, which ignores releases of mapped memory,
+// so popped elems must be released with heap_release_elem or
+// allocator_release. A store must only be closed once the structs
+// loaded from it, and any elems popped from them, are done with.
+//
+// Heaps created with heap_create_small are saved with every payload
+// in the payload section and load as ordinary heaps.
+//
+// Pointer arrays do not record the size of their elements, so
+// array_save is given a function returning the size of each one. It is
+// not needed for inline arrays.
+//
+// The store functions require the alloc, array and heap structs.
+
+
+/////////////////////////////////////////////////////////////
+// STORE TYPES
+//
+
+#define STORE_MAGIC   "STRC"
+#define STORE_VERSION 1
+
+enum store_e {
+  S_ERR = 0, S_OK, STORE_ARRAY, STORE_HEAP
+};
+
+struct store_header {
+  char     magic[4];
+  uint32_t version;
+  uint32_t kind;    // STORE_ARRAY or STORE_HEAP
+  uint32_t width;   // sizeof(void*) of the writer
+  uint64_t count;
+  uint64_t stride;  // Element stride, 0 for pointer arrays
+  uint64_t type;    // Heap type
+  uint64_t arity;   // Heap arity
+  uint64_t slots;   // Offset of the slots or elems
+  uint64_t keys;    // Offset of the heap keys
+  uint64_t payload; // Offset of the payloads
+  uint64_t bytes;   // Size of the whole file
+};
+
+struct store {
+  char             *base;
+  size_t           bytes;
+  struct allocator allocator;
+};
+
+typedef size_t(*store_size_func)(void*);
+
+
+/////////////////////////////////////////////////////////////
+// STORE FUNCTION DECLARATION
+//
+
+// Functions to map and unmap saved files
+struct store* store_open(const char *path);
+void          store_close(struct store *store);
+
+// Functions to save and load arrays and heaps
+int           array_save(struct array *array, const char *path, store_size_func size);
+struct array* array_load(struct store *store);
+int           heap_save(struct heap *heap, const char *path);
+struct heap*  heap_load(struct store *store);
+
+
+#endif // _STORE_H
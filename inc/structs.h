@@ -31,20 +31,43 @@
 
 // Cstd Libs
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
 // Local includes
+#include "alloc.h"
+#include "stats.h"
+#include "hist.h"
+#include "pool.h"
 #include "array.h"
 #include "heap.h"
+#include "pheap.h"
+#include "pqueue.h"
+#include "queue.h"
+#include "radix.h"
+#include "store.h"
+#include "typed.h"
 
 
 /////////////////////////////////////////////////////////////
 // STRUCTS FUNCTION DECLARATION
 //
 
+void alloc_tests();
 void array_tests();
+void hist_tests();
 void heap_tests();
+void pheap_tests();
+void pool_tests();
+void pqueue_tests();
+void queue_tests();
+void radix_tests();
+void store_tests();
+void typed_tests();
 
 
 #endif // _STRUCTS_H
@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - typed.h
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TYPED_H
+#define _TYPED_H
+
+
+/////////////////////////////////////////////////////////////
+// TYPED DESCRIPTION
+//
+// The typed macros generate arrays and heaps specialised to a single
+// element type, for when the void pointer and size interface of the
+// array and heap structs costs more than the work being done, as it
+// does for plain integers. Elements are stored directly in a buffer of
+// the type, passed and returned by value, and every function is static
+// inline so the compiler can see through all of it.
+//
+// ARRAY_DEFINE(type, name) declares struct name and the functions
+// name_create, name_free, name_reserve, name_append, name_get,
+// name_at, name_set, name_pop_end and name_size.
+//
+// HEAP_DEFINE(type, name, before) declares struct name and the
+// functions name_create, name_free, name_reserve, name_add, name_pop,
+// name_top and name_size. before(a, b) must be true when a belongs
+// nearer the root than b; it may be a macro or a function and is
+// fixed when the heap is generated, so there is no branch on the heap
+// type. A min-heap of integers is HEAP_DEFINE(int, int_heap, TYPED_LESS).
+//
+// name_get is the one unchecked accessor: it reads any position as it
+// stands, for loops already bounded by name_size. name_at returns NULL
+// past the end, name_set fails with A_ERR there, and name_pop_end and
+// name_pop and name_top return their value through a pointer and fail
+// with A_ERR or H_ERR when the container is empty.
+//
+// The generated containers grow by ARRAY_GROWTH like the array struct
+// and use the same A_OK, A_ERR, H_OK and H_ERR return values. Each
+// macro is expanded once at file scope per type.
+//
+// The typed macros require the array and heap structs.
+
+
+/////////////////////////////////////////////////////////////
+// TYPED TYPES
+//
+
+#define TYPED_LESS(a, b)    ((a) < (b))
+#define TYPED_GREATER(a, b) ((a) > (b))
+
+
+/////////////////////////////////////////////////////////////
+// TYPED ARRAY DEFINITION
+//
+
+#define ARRAY_DEFINE(type, name)                                        \
+                                                                        \
+struct name {                                                           \
+  type   *data;                                                         \
+  size_t count;                                                         \
+  size_t capacity;                                                      \
+};                                                                      \
+                                                                        \
+static inline struct name* name##_create(size_t size) {                 \
+  struct name *array = malloc(sizeof(struct name));                     \
+                                                                        \
+  if(array) {                                                           \
+    array->data     = size ? malloc(sizeof(type) * size) : NULL;        \
+    array->count    = 0;                                                \
+    array->capacity = array->data ? size : 0;                           \
+  }                                                                     \
+                                                                        \
+  return array;                                                         \
+}                                                                       \
+                                                                        \
+static inline void name##_free(struct name *array) {                    \
+  if(array) {                                                           \
+    free(array->data);                                                  \
+    free(array);                                                        \
+  }                                                                     \
+}                                                                       \
+                                                                        \
+static inline int name##_reserve(struct name *array, size_t size) {     \
+  if(size <= array->capacity)                                           \
+    return A_OK;                                                        \
+                                                                        \
+  type *data = realloc(array->data, sizeof(type) * size);               \
+                                                                        \
+  if(!data)                                                             \
+    return A_ERR;                                                       \
+                                                                        \
+  array->data     = data;                                               \
+  array->capacity = size;                                               \
+  return A_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline int name##_append(struct name *array, type value) {       \
+  /* Grow geometrically as the array struct does */                     \
+  if(array->count == array->capacity) {                                 \
+    size_t size = (size_t)(array->capacity * ARRAY_GROWTH);             \
+                                                                        \
+    if(size < array->capacity + ARRAY_MIN_GROW)                         \
+      size = array->capacity + ARRAY_MIN_GROW;                          \
+                                                                        \
+    if(!name##_reserve(array, size))                                    \
+      return A_ERR;                                                     \
+  }                                                                     \
+                                                                        \
+  array->data[array->count++] = value;                                  \
+  return A_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline type name##_get(struct name *array, size_t pos) {         \
+  return array->data[pos];                                              \
+}                                                                       \
+                                                                        \
+static inline type* name##_at(struct name *array, size_t pos) {         \
+  return pos < array->count ? &array->data[pos] : NULL;                 \
+}                                                                       \
+                                                                        \
+static inline int name##_set(struct name *array, size_t pos, type value) { \
+  if(pos >= array->count)                                               \
+    return A_ERR;                                                       \
+                                                                        \
+  array->data[pos] = value;                                             \
+  return A_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline int name##_pop_end(struct name *array, type *value) {     \
+  if(!array->count)                                                     \
+    return A_ERR;                                                       \
+                                                                        \
+  *value = array->data[--array->count];                                 \
+  return A_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline size_t name##_size(struct name *array) {                  \
+  return array ? array->count : 0;                                      \
+}
+
+
+/////////////////////////////////////////////////////////////
+// TYPED HEAP DEFINITION
+//
+
+#define HEAP_DEFINE(type, name, before)                                 \
+                                                                        \
+ARRAY_DEFINE(type, name##_array)                                        \
+                                                                        \
+struct name {                                                           \
+  struct name##_array array;                                            \
+};                                                                      \
+                                                                        \
+static inline struct name* name##_create(size_t size) {                 \
+  struct name *heap = malloc(sizeof(struct name));                      \
+                                                                        \
+  if(heap) {                                                            \
+    heap->array.data     = size ? malloc(sizeof(type) * size) : NULL;   \
+    heap->array.count    = 0;                                           \
+    heap->array.capacity = heap->array.data ? size : 0;                 \
+  }                                                                     \
+                                                                        \
+  return heap;                                                          \
+}                                                                       \
+                                                                        \
+static inline void name##_free(struct name *heap) {                     \
+  if(heap) {                                                            \
+    free(heap->array.data);                                             \
+    free(heap);                                                         \
+  }                                                                     \
+}                                                                       \
+                                                                        \
+static inline int name##_reserve(struct name *heap, size_t size) {      \
+  return name##_array_reserve(&heap->array, size) ? H_OK : H_ERR;       \
+}                                                                       \
+                                                                        \
+static inline int name##_add(struct name *heap, type value) {           \
+  if(!name##_array_append(&heap->array, value))                         \
+    return H_ERR;                                                       \
+                                                                        \
+  /* Move parents down into the hole until the value fits */            \
+  type *data   = heap->array.data;                                      \
+  size_t index = heap->array.count - 1;                                 \
+                                                                        \
+  while(index > 0) {                                                    \
+    size_t parent = (index - 1) / HEAP_ARITY;                           \
+                                                                        \
+    if(!(before(value, data[parent])))                                  \
+      break;                                                            \
+                                                                        \
+    data[index] = data[parent];                                         \
+    index       = parent;                                               \
+  }                                                                     \
+                                                                        \
+  data[index] = value;                                                  \
+  return H_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline int name##_pop(struct name *heap, type *value) {          \
+  if(!heap->array.count)                                                \
+    return H_ERR;                                                       \
+                                                                        \
+  type *data   = heap->array.data;                                      \
+  size_t size  = --heap->array.count;                                   \
+  type last    = data[size];                                            \
+  size_t index = 0;                                                     \
+                                                                        \
+  *value = data[0];                                                     \
+                                                                        \
+  /* Move the best child up into the hole until the last value fits */  \
+  for(;;) {                                                             \
+    size_t child = (index * HEAP_ARITY) + 1;                            \
+                                                                        \
+    if(child >= size)                                                   \
+      break;                                                            \
+                                                                        \
+    size_t best = child;                                                \
+    size_t end  = child + HEAP_ARITY < size ? child + HEAP_ARITY : size; \
+                                                                        \
+    for(size_t i = child + 1; i < end; i++) {                           \
+      if(before(data[i], data[best]))                                   \
+        best = i;                                                       \
+    }                                                                   \
+                                                                        \
+    if(!(before(data[best], last)))                                     \
+      break;                                                            \
+                                                                        \
+    data[index] = data[best];                                           \
+    index       = best;                                                 \
+  }                                                                     \
+                                                                        \
+  if(size)                                                              \
+    data[index] = last;                                                 \
+                                                                        \
+  return H_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline int name##_top(struct name *heap, type *value) {          \
+  if(!heap->array.count)                                                \
+    return H_ERR;                                                       \
+                                                                        \
+  *value = heap->array.data[0];                                         \
+  return H_OK;                                                          \
+}                                                                       \
+                                                                        \
+static inline size_t name##_size(struct name *heap) {                   \
+  return heap ? heap->array.count : 0;                                  \
+}
+
+
+#endif // _TYPED_H
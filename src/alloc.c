@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - alloc.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// ALLOC STATIC FUNCTIONS
+//
+
+static inline size_t alloc_align(size_t size) {
+  return (size + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1);
+}
+
+
+static void* arena_alloc_ctx(void *ctx, size_t size) {
+  return arena_alloc(ctx, size);
+}
+
+
+static void* slab_alloc_ctx(void *ctx, size_t size) {
+  struct slab *slab = ctx;
+
+  // Slabs can only serve objects up to their fixed size
+  if(size > slab->size)
+    return NULL;
+
+  return slab_alloc(slab);
+}
+
+
+static void slab_release_ctx(void *ctx, void *ptr) {
+  slab_release(ctx, ptr);
+}
+
+
+static struct arena_block* arena_block_create(size_t size) {
+  struct arena_block *block = malloc(sizeof(struct arena_block) + size);
+
+  if(block) {
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+  }
+
+  return block;
+}
+
+
+/////////////////////////////////////////////////////////////
+// ALLOC FUNCTION IMPLEMENTATION
+//
+
+void* allocator_alloc(struct allocator *alloc, size_t size) {
+  if(alloc == NULL)
+    return malloc(size);
+
+  return alloc->alloc(alloc->ctx, size);
+}
+
+
+void allocator_release(struct allocator *alloc, void *ptr) {
+  if(alloc == NULL)
+    free(ptr);
+  else if(alloc->release != NULL)
+    alloc->release(alloc->ctx, ptr);
+}
+
+
+struct arena* arena_create(size_t block_size) {
+  struct arena *arena = malloc(sizeof(struct arena));
+
+  if(arena) {
+    arena->head       = NULL;
+    arena->block_size = alloc_align(block_size ? block_size : 4096);
+
+    // Arenas ignore individual frees
+    arena->allocator.alloc   = arena_alloc_ctx;
+    arena->allocator.release = NULL;
+    arena->allocator.ctx     = arena;
+  }
+
+  return arena;
+}
+
+
+void arena_free(struct arena *arena) {
+  if(arena) {
+    arena_reset(arena);
+    free(arena->head);
+    free(arena);
+  }
+}
+
+
+void arena_reset(struct arena *arena) {
+  if(arena) {
+    if(arena->head != NULL) {
+      // Free every block but the newest which is kept for reuse
+      struct arena_block *block = arena->head->next;
+
+      while(block != NULL) {
+        struct arena_block *next = block->next;
+        free(block);
+        block = next;
+      }
+
+      arena->head->next = NULL;
+      arena->head->used = 0;
+    }
+  }
+}
+
+
+void* arena_alloc(struct arena *arena, size_t size) {
+  void *data = NULL;
+
+  if(arena) {
+    size = alloc_align(size ? size : 1);
+
+    // Start a new block when the current one cannot fit the request
+    if(arena->head == NULL || arena->head->size - arena->head->used < size) {
+      size_t block_size = size > arena->block_size ? size : arena->block_size;
+      struct arena_block *block = arena_block_create(block_size);
+
+      if(block == NULL)
+        return data;
+
+      block->next = arena->head;
+      arena->head = block;
+    }
+
+    data = arena->head->data + arena->head->used;
+    arena->head->used += size;
+  }
+
+  return data;
+}
+
+
+struct allocator* arena_allocator(struct arena *arena) {
+  struct allocator *alloc = NULL;
+
+  if(arena)
+    alloc = &arena->allocator;
+
+  return alloc;
+}
+
+
+struct slab* slab_create(size_t size, size_t count) {
+  struct slab *slab = malloc(sizeof(struct slab));
+
+  if(slab) {
+    // Objects must be large enough to hold a free list link
+    slab->blocks    = NULL;
+    slab->free_list = NULL;
+    slab->size      = alloc_align(size < sizeof(void*) ? sizeof(void*) : size);
+    slab->count     = count ? count : 64;
+
+    slab->allocator.alloc   = slab_alloc_ctx;
+    slab->allocator.release = slab_release_ctx;
+    slab->allocator.ctx     = slab;
+  }
+
+  return slab;
+}
+
+
+void slab_free(struct slab *slab) {
+  if(slab) {
+    struct slab_block *block = slab->blocks;
+
+    while(block != NULL) {
+      struct slab_block *next = block->next;
+      free(block);
+      block = next;
+    }
+
+    free(slab);
+  }
+}
+
+
+void* slab_alloc(struct slab *slab) {
+  void *data = NULL;
+
+  if(slab) {
+    if(slab->free_list == NULL) {
+      // Carve a new block into objects and thread them on the free list
+      struct slab_block *block = malloc(sizeof(struct slab_block) + slab->size * slab->count);
+
+      if(block == NULL)
+        return data;
+
+      block->next  = slab->blocks;
+      slab->blocks = block;
+
+      for(size_t i = slab->count; i > 0; i--) {
+        void *object = block->data + (i - 1) * slab->size;
+        *(void**)object = slab->free_list;
+        slab->free_list = object;
+      }
+    }
+
+    data = slab->free_list;
+    slab->free_list = *(void**)data;
+  }
+
+  return data;
+}
+
+
+void slab_release(struct slab *slab, void *ptr) {
+  if(slab && ptr) {
+    *(void**)ptr    = slab->free_list;
+    slab->free_list = ptr;
+  }
+}
+
+
+struct allocator* slab_allocator(struct slab *slab) {
+  struct allocator *alloc = NULL;
+
+  if(slab)
+    alloc = &slab->allocator;
+
+  return alloc;
+}
@@ -24,23 +24,474 @@
 #include "structs.h"
 
 
+/////////////////////////////////////////////////////////////
+// ARRAY STATIC FUNCTIONS
+//
+
+static inline size_t array_width(struct array *array) {
+  // Inline arrays hold the element itself, otherwise a pointer
+  return array->stride ? array->stride : sizeof(void*);
+}
+
+
+static inline size_t array_bytes(struct array *array, size_t capacity) {
+  // Inline arrays keep one spare slot past capacity for popped items
+  if(array->stride)
+    return (capacity + 1) * array->stride;
+
+  return capacity * sizeof(void*);
+}
+
+
+static inline int array_owns(struct array *array) {
+  // Pointer arrays own their elements unless they are views
+  return !array->stride && !(array->flags & A_VIEW);
+}
+
+
+static inline char* array_at(struct array *array, size_t index) {
+  // Address of a physical slot in the buffer
+  return (char*)array->data + (index * array_width(array));
+}
+
+
+static inline char* array_slot(struct array *array, size_t pos) {
+  // Positions start at head and wrap around the end of the buffer
+  size_t index = array->head + pos;
+
+  if(index >= array->capacity)
+    index -= array->capacity;
+
+  return array_at(array, index);
+}
+
+
+static inline void* array_elem(struct array *array, size_t pos) {
+  if(array->stride)
+    return array_slot(array, pos);
+
+  return *(void**)array_slot(array, pos);
+}
+
+
+static int array_store(struct array *array, size_t pos, void *data, size_t size) {
+  if(array->stride) {
+    // Copy the data straight into the slot and clear any remainder
+    if(size > array->stride)
+      return A_ERR;
+
+    char *slot = array_slot(array, pos);
+    memcpy(slot, data, size);
+    STATS_ADD(array, bytes_copied, size);
+    memset(slot + size, 0, array->stride - size);
+  } else if(array->flags & A_VIEW) {
+    // Views borrow the caller's pointer
+    *(void**)array_slot(array, pos) = data;
+  } else {
+    // Copy the data and keep a pointer to it
+    void *copy = allocator_alloc(array->alloc, size);
+
+    if(copy == NULL)
+      return A_ERR;
+
+    memcpy(copy, data, size);
+    *(void**)array_slot(array, pos) = copy;
+    STATS_ADD(array, allocs, 1);
+    STATS_ADD(array, bytes_copied, size);
+  }
+
+  return A_OK;
+}
+
+
+static int array_store_range(struct array *array, size_t pos, void *data, size_t count, size_t size) {
+  for(size_t i = 0; i < count; i++) {
+    if(!array_store(array, pos + i, (char*)data + (i * size), size)) {
+      // Release any copies we already made before failing
+      while(array_owns(array) && i--)
+        allocator_release(array->alloc, array_elem(array, pos + i));
+
+      return A_ERR;
+    }
+  }
+
+  return A_OK;
+}
+
+
+static int array_relocate(struct array *array, size_t capacity) {
+  // Copy the elements into a new buffer so that head is at the front
+  void **tarray = malloc(array_bytes(array, capacity));
+
+  if(tarray == NULL)
+    return A_ERR;
+
+  size_t width = array_width(array);
+  size_t first = array->capacity - array->head;
+
+  if(first > array->count)
+    first = array->count;
+
+  memcpy(tarray, array_at(array, array->head), first * width);
+  memcpy((char*)tarray + (first * width), array->data, (array->count - first) * width);
+  STATS_ADD(array, allocs, 1);
+  STATS_ADD(array, bytes_copied, array->count * width);
+
+  // Mapped buffers belong to their store and are left alone
+  if(!(array->flags & A_MAPPED))
+    free(array->data);
+
+  array->flags   &= ~A_MAPPED;
+  array->data     = tarray;
+  array->capacity = capacity;
+  array->head     = 0;
+
+  return A_OK;
+}
+
+
+static size_t array_grow_size(struct array *array) {
+  // Grow geometrically but never by less than the minimum
+  size_t newsize = (size_t)(array->capacity * (array->growth - 1.0));
+
+  if(newsize < ARRAY_MIN_GROW)
+    newsize = ARRAY_MIN_GROW;
+
+  return newsize;
+}
+
+
+static int array_grow(struct array *array, size_t size) {
+  if(array->data != NULL && size <= array->capacity)
+    return A_OK;
+
+  // Grow geometrically unless the request needs even more room
+  size_t newsize = array_grow_size(array);
+
+  if(array->capacity + newsize < size)
+    newsize = size - array->capacity;
+
+  return array_resize(array, newsize);
+}
+
+
+static int array_open(struct array *array, size_t pos, size_t count) {
+  if(!array_grow(array, array->count + count))
+    return A_ERR;
+
+  // Shifting and copying need the range to be contiguous
+  if(array->head + array->count + count > array->capacity && !array_linearize(array))
+    return A_ERR;
+
+  // Move everything after pos back count spaces
+  memmove(array_slot(array, pos + count), array_slot(array, pos),
+    (array->count - pos) * array_width(array));
+  STATS_ADD(array, moves, array->count - pos);
+
+  return A_OK;
+}
+
+
+static void array_close(struct array *array, size_t pos, size_t count) {
+  // Move everything after the gap forward count spaces
+  memmove(array_slot(array, pos), array_slot(array, pos + count),
+    (array->count - pos) * array_width(array));
+}
+
+
+static void* array_remove(struct array *array, size_t pos) {
+  void *data = NULL;
+
+  // Shifting needs the elements to be contiguous
+  if(array->head + array->count > array->capacity && !array_linearize(array))
+    return data;
+
+  if(array->stride) {
+    // Park the element in the spare slot so it outlives the shift
+    data = array_at(array, array->capacity);
+    memcpy(data, array_slot(array, pos), array->stride);
+  } else {
+    data = array_elem(array, pos);
+  }
+
+  // Move all following elements forward one space
+  memmove(array_slot(array, pos), array_slot(array, pos + 1),
+    (array->count - pos - 1) * array_width(array));
+  STATS_ADD(array, moves, array->count - pos - 1);
+
+  --array->count;
+  return data;
+}
+
+
+// Shared state of one array_sort call and the work given to each thread
+struct array_sort {
+  array_cmp cmp;
+  size_t    width;
+  int       inline_elems;
+};
+
+struct array_sort_task {
+  struct array_sort *sort;
+  char   *a;
+  char   *b;
+  char   *out;
+  size_t m;
+  size_t k;
+  size_t lo;
+  size_t hi;
+};
+
+
+static inline int array_sort_cmp(struct array_sort *sort, char *a, char *b) {
+  // Inline elements are compared in place, pointer elements by target
+  if(sort->inline_elems)
+    return sort->cmp(a, b);
+
+  return sort->cmp(*(void**)a, *(void**)b);
+}
+
+
+static inline void array_sort_copy(struct array_sort *sort, char *dest, char *src, size_t count) {
+  // Pointer sized elements are moved by word rather than by memcpy
+  if(sort->width == sizeof(void*)) {
+    for(size_t i = 0; i < count; i++)
+      ((void**)dest)[i] = ((void**)src)[i];
+  } else {
+    memcpy(dest, src, count * sort->width);
+  }
+}
+
+
+static void array_sort_merge(struct array_sort *sort, char *a, size_t m, char *b, size_t k, char *out) {
+  size_t width = sort->width;
+  size_t i = 0, j = 0;
+
+  if(width == sizeof(void*)) {
+    // Word sized elements are merged without going through memcpy
+    void **wa = (void**)a, **wb = (void**)b, **wout = (void**)out;
+
+    while(i < m && j < k) {
+      if(array_sort_cmp(sort, (char*)&wb[j], (char*)&wa[i]) < 0)
+        *wout++ = wb[j++];
+      else
+        *wout++ = wa[i++];
+    }
+
+    out = (char*)wout;
+  }
+
+  // Take from a on ties so the sort is stable
+  while(i < m && j < k) {
+    if(array_sort_cmp(sort, b + j * width, a + i * width) < 0) {
+      array_sort_copy(sort, out, b + j * width, 1);
+      ++j;
+    } else {
+      array_sort_copy(sort, out, a + i * width, 1);
+      ++i;
+    }
+
+    out += width;
+  }
+
+  array_sort_copy(sort, out, a + i * width, m - i);
+  array_sort_copy(sort, out + (m - i) * width, b + j * width, k - j);
+}
+
+
+static size_t array_sort_corank(struct array_sort *sort, char *a, size_t m, char *b, size_t k, size_t d) {
+  // Count how many of the first d merged elements come from a
+  size_t lo = d > k ? d - k : 0;
+  size_t hi = d < m ? d : m;
+
+  while(lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    size_t j = d - i;
+
+    if(j > 0 && array_sort_cmp(sort, a + i * sort->width, b + (j - 1) * sort->width) <= 0)
+      lo = i + 1;
+    else
+      hi = i;
+  }
+
+  return lo;
+}
+
+
+static void* array_sort_piece(void *arg) {
+  struct array_sort_task *task = arg;
+  struct array_sort *sort      = task->sort;
+
+  // Merge the outputs lo to hi of a and b, found by their co-ranks
+  size_t i0 = array_sort_corank(sort, task->a, task->m, task->b, task->k, task->lo);
+  size_t i1 = array_sort_corank(sort, task->a, task->m, task->b, task->k, task->hi);
+  size_t j0 = task->lo - i0;
+  size_t j1 = task->hi - i1;
+
+  array_sort_merge(sort, task->a + i0 * sort->width, i1 - i0, task->b + j0 * sort->width,
+    j1 - j0, task->out + task->lo * sort->width);
+
+  return NULL;
+}
+
+
+static void* array_sort_chunk(void *arg) {
+  struct array_sort_task *task = arg;
+  struct array_sort *sort      = task->sort;
+  size_t width                 = sort->width;
+  char *data                   = task->a;
+  char *tmp                    = task->b;
+
+  // Insertion sort short runs, using the start of tmp as a spare slot
+  for(size_t lo = 0; lo < task->m; lo += ARRAY_SORT_RUN) {
+    size_t hi = lo + ARRAY_SORT_RUN < task->m ? lo + ARRAY_SORT_RUN : task->m;
+
+    for(size_t i = lo + 1; i < hi; i++) {
+      size_t j = i;
+
+      while(j > lo && array_sort_cmp(sort, data + i * width, data + (j - 1) * width) < 0)
+        --j;
+
+      if(j < i) {
+        memcpy(tmp, data + i * width, width);
+        memmove(data + (j + 1) * width, data + j * width, (i - j) * width);
+        memcpy(data + j * width, tmp, width);
+      }
+    }
+  }
+
+  // Merge runs of doubling length back and forth between the buffers
+  for(size_t run = ARRAY_SORT_RUN; run < task->m; run *= 2) {
+    for(size_t lo = 0; lo < task->m; lo += run * 2) {
+      size_t mid = lo + run < task->m ? lo + run : task->m;
+      size_t hi  = lo + run * 2 < task->m ? lo + run * 2 : task->m;
+
+      array_sort_merge(sort, data + lo * width, mid - lo, data + mid * width, hi - mid, tmp + lo * width);
+    }
+
+    char *swap = data;
+    data       = tmp;
+    tmp        = swap;
+  }
+
+  if(data != task->a)
+    memcpy(task->a, data, task->m * width);
+
+  return NULL;
+}
+
+
+static void array_sort_run(struct array_sort_task *tasks, size_t count, void*(*func)(void*)) {
+  pthread_t threads[ARRAY_SORT_THREADS];
+  int started[ARRAY_SORT_THREADS];
+
+  // The calling thread takes the last task itself
+  for(size_t i = 0; i + 1 < count; i++)
+    started[i] = pthread_create(&threads[i], NULL, func, &tasks[i]) == 0;
+
+  func(&tasks[count - 1]);
+
+  for(size_t i = 0; i + 1 < count; i++) {
+    if(started[i])
+      pthread_join(threads[i], NULL);
+    else
+      func(&tasks[i]);
+  }
+}
+
+
+// State of one parallel call shared by every chunk
+struct array_parallel {
+  struct array   *array;
+  array_ctx_func func;
+  array_map_func map;
+  void   *ctx;
+  char   *partials;
+  size_t size;
+  size_t chunks;
+};
+
+
+static size_t array_parallel_chunks(struct array *array, size_t nthreads) {
+  size_t chunks = array->count / ARRAY_PARALLEL_MIN;
+
+  if(nthreads > POOL_THREADS)
+    nthreads = POOL_THREADS;
+
+  // Enough chunks to balance the threads but none too small
+  if(chunks > nthreads * ARRAY_PARALLEL_CHUNKS)
+    chunks = nthreads * ARRAY_PARALLEL_CHUNKS;
+
+  return chunks ? chunks : 1;
+}
+
+
+static void array_parallel_chunk(void *arg, size_t chunk) {
+  struct array_parallel *job = arg;
+  size_t count               = job->array->count;
+  size_t lo                  = count * chunk / job->chunks;
+  size_t hi                  = count * (chunk + 1) / job->chunks;
+
+  if(job->map) {
+    void *acc = job->partials + chunk * job->size;
+
+    for(size_t i = lo; i < hi; i++)
+      job->map(acc, array_elem(job->array, i), job->ctx);
+  } else {
+    for(size_t i = lo; i < hi; i++)
+      job->func(array_elem(job->array, i), job->ctx);
+  }
+}
+
+
 /////////////////////////////////////////////////////////////
 // ARRAY FUNCTION IMPLEMENTATION
 //
 
 
 struct array* array_create(size_t size) {
+  return array_create_inline(size, 0);
+}
+
+
+struct array* array_create_inline(size_t size, size_t stride) {
+  return array_create_alloc(size, stride, NULL);
+}
+
+
+struct array* array_create_view(size_t size) {
+  struct array *array = array_create(size);
+
+  if(array)
+    array->flags |= A_VIEW;
+
+  return array;
+}
+
+
+struct array* array_create_alloc(size_t size, size_t stride, struct allocator *alloc) {
   // Allocate memory to the array struct
   struct array *array = malloc(sizeof(struct array));
 
   if(array) {
+    array->stride = stride;
+    array->head   = 0;
+    array->flags  = 0;
+    array->growth = ARRAY_GROWTH;
+    array->alloc  = alloc;
+
+#ifdef STATS_BUILD
+    stats_clear(&array->stats);
+#endif
+
     if(size) {
       // Allocate and initialize memory
-      array->data = calloc(1, sizeof(void*) * size);
+      array->data = calloc(1, array_bytes(array, size));
 
       if(array->data) {
         array->capacity = size;
         array->count    = 0;
+        STATS_ADD(array, allocs, 1);
       } else {
         // On fail returns null
         free(array);
@@ -62,10 +513,14 @@ void array_free(struct array *array) {
   if(array) {
     if(array->data != NULL) {
 
-      if(array->count)
-        array_for_each(array, free); // Free each element
+      // Free each element unless the allocator ignores frees
+      if(array->count && array_owns(array) && (array->alloc == NULL || array->alloc->release)) {
+        for(size_t i = 0; i < array->count; i++)
+          allocator_release(array->alloc, array_elem(array, i));
+      }
 
-      free(array->data); // Free array data
+      if(!(array->flags & A_MAPPED))
+        free(array->data); // Free array data
     }
 
     free(array); // Free our array struct
@@ -77,22 +532,28 @@ int array_resize(struct array *array, size_t size) {
   int rvalue = A_ERR; // Fail by design
 
   if(array) {
-    size_t newsize = 5;
+    size_t newsize = array_grow_size(array);
 
     if(size)
       newsize = size;
 
-    if(array->data != NULL) {
-      // Realocate memory either the default of +5 or user specified
-      void **tarray = realloc(array->data, (array->capacity + newsize) * sizeof(void*));
-
-      array->capacity += newsize;
-      array->data      = tarray;
-      rvalue           = A_OK;
+    if(array->head || (array->flags & A_MAPPED)) {
+      // Wrapped or mapped arrays are copied out into the new buffer
+      rvalue = array_relocate(array, array->capacity + newsize);
     } else {
-      array->data      = malloc(sizeof(void*) * newsize);
-      array->capacity += newsize;
-      rvalue           = A_OK;
+      // Realocate memory either geometrically or by the user specified amount
+      void **tarray = realloc(array->data, array_bytes(array, array->capacity + newsize));
+
+      if(tarray) {
+        if(array->data != NULL)
+          STATS_ADD(array, reallocs, 1);
+        else
+          STATS_ADD(array, allocs, 1);
+
+        array->capacity += newsize;
+        array->data      = tarray;
+        rvalue           = A_OK;
+      }
     }
   }
 
@@ -100,6 +561,47 @@ int array_resize(struct array *array, size_t size) {
 }
 
 
+int array_reserve(struct array *array, size_t size) {
+  int rvalue = A_ERR;
+
+  if(array) {
+    rvalue = A_OK;
+
+    // Only ever grow the array to exactly the requested capacity
+    if(size > array->capacity)
+      rvalue = array_resize(array, size - array->capacity);
+  }
+
+  return rvalue;
+}
+
+
+int array_linearize(struct array *array) {
+  int rvalue = A_ERR;
+
+  if(array) {
+    rvalue = A_OK;
+
+    if(array->head)
+      rvalue = array_relocate(array, array->capacity);
+  }
+
+  return rvalue;
+}
+
+
+int array_set_growth(struct array *array, double factor) {
+  int rvalue = A_ERR;
+
+  if(array && factor > 1.0) {
+    array->growth = factor;
+    rvalue        = A_OK;
+  }
+
+  return rvalue;
+}
+
+
 int array_insert(struct array *array, size_t pos, void *data, size_t size) {
   int rvalue = A_ERR;
 
@@ -108,31 +610,48 @@ int array_insert(struct array *array, size_t pos, void *data, size_t size) {
     if(array->data == NULL || pos == array->count)
       return array_append(array, data, size);
 
-    if(++array->count < array->capacity) {
-      for(size_t i = array->count; i > pos; --i)
-        array->data[i] = array->data[i - 1];
+    rvalue = array_insert_range(array, pos, data, 1, size);
+  }
+
+  return rvalue;
+}
 
-      // Copy the data and add to our array
-      void *copy = calloc(1, size);
-      memcpy(copy, data, size);
-      array->data[pos] = copy;
+
+int array_insert_range(struct array *array, size_t pos, void *data, size_t count, size_t size) {
+  int rvalue = A_ERR;
+
+  if(array && pos <= array->count) {
+    // Make room for the whole range up front
+    if(!array_open(array, pos, count))
+      return rvalue;
+
+    if(array->stride && array->stride == size) {
+      // Elements of the same stride can be copied in one go
+      memcpy(array_slot(array, pos), data, count * size);
+      STATS_ADD(array, bytes_copied, count * size);
       rvalue = A_OK;
     } else {
-      // Increase the capacity of our array to handle the insert
-      size_t newsize = array->capacity + 5;
-      void **tarry = realloc(array->data, sizeof(void*) * newsize);
+      rvalue = array_store_range(array, pos, data, count, size);
+    }
 
-      for(size_t i = array->count; i > pos; --i)
-        tarry[i] = tarry[i - 1];
+    if(rvalue)
+      array->count += count;
+    else
+      array_close(array, pos, count);
+  }
 
-      // Copy the data and add to our array
-      void *copy = calloc(1, size);
-      memcpy(copy, data, size);
+  return rvalue;
+}
 
-      // Add the reconfigured vars to our array
-      array->data      = tarry;
-      array->data[pos] = copy;
-      array->capacity  = newsize;
+
+int array_adopt(struct array *array, size_t pos, void *data) {
+  int rvalue = A_ERR;
+
+  // Only pointer arrays can hold on to the caller's block
+  if(array && !array->stride && pos <= array->count) {
+    if(array_open(array, pos, 1)) {
+      *(void**)array_slot(array, pos) = data;
+      ++array->count;
       rvalue = A_OK;
     }
   }
@@ -141,52 +660,102 @@ int array_insert(struct array *array, size_t pos, void *data, size_t size) {
 }
 
 
+int array_push_ptr(struct array *array, void *data) {
+  int rvalue = A_ERR;
+
+  if(array)
+    rvalue = array_adopt(array, array->count, data);
+
+  return rvalue;
+}
+
+
 int array_append(struct array *array, void *data, size_t size) {
   int rvalue = A_ERR;
 
   if(array) {
     // If there is not room in the array resize
-    if(array->data == NULL || array->capacity == array->count)
-      array_resize(array, 0);
+    if(!array_grow(array, array->count + 1))
+      return rvalue;
 
     // Copy the data and add to our array
-    void *copy = calloc(1, size);
-    memcpy(copy, data, size);
-    array->data[array->count++] = copy;
-    rvalue = A_OK;
+    rvalue = array_store(array, array->count, data, size);
+
+    if(rvalue)
+      ++array->count;
+  }
+
+  return rvalue;
+}
+
+
+int array_prepend(struct array *array, void *data, size_t size) {
+  int rvalue = A_ERR;
+
+  if(array) {
+    // If there is not room in the array resize
+    if(!array_grow(array, array->count + 1))
+      return rvalue;
+
+    // Step head back one slot wrapping to the end of the buffer
+    size_t head = array->head;
+    array->head = (head ? head : array->capacity) - 1;
+
+    rvalue = array_store(array, 0, data, size);
+
+    if(rvalue)
+      ++array->count;
+    else
+      array->head = head;
   }
 
   return rvalue;
 }
 
 
+int array_append_n(struct array *array, void *data, size_t count, size_t size) {
+  int rvalue = A_ERR;
+
+  if(array)
+    rvalue = array_insert_range(array, array->count, data, count, size);
+
+  return rvalue;
+}
+
+
 int array_set(struct array *array, size_t pos, void *data, size_t size) {
   int rvalue = A_ERR;
 
   if(array) {
     // Verify that the desired position is available
     if(array->data != NULL && pos < array->count) {
-      // Copy data to our array
-      void *copy = calloc(1, size);
-      memcpy(copy, data, size);
+      void *old = array_owns(array) ? array_elem(array, pos) : NULL;
 
-      if(array->data[pos] != NULL)
-        free(array->data[pos]);
+      // Copy data to our array
+      rvalue = array_store(array, pos, data, size);
 
-      array->data[pos] = copy;
+      if(rvalue && old != NULL)
+        allocator_release(array->alloc, old);
     }
   }
   return rvalue;
 }
 
 
-void array_copy_from(struct array *dest, struct array *src, size_t index) {
-  if(dest && src) {
+int array_copy_from(struct array *dest, struct array *src, size_t index) {
+  int rvalue = A_ERR;
+
+  // Pointer elements are shared so only a view can take them
+  if(dest && src && (src->stride || (dest->flags & A_VIEW))) {
+    rvalue = A_OK;
+
     if(src->data != NULL && index < src->count) {
-      for(size_t i = index; i < src->count; i++)
-        array_append(dest, array_get(src, i), sizeof(void*));
+      for(size_t i = index; rvalue && i < src->count; i++)
+        rvalue = array_append(dest, array_get(src, i), array_width(src));
     }
   }
+
+  return rvalue;
 }
 
 
@@ -194,9 +763,138 @@ void array_for_each(struct array *array, array_func func) {
   if(array) {
     if(array->data != NULL) {
       for(size_t i = 0; i < array->count; i++)
-        func(array->data[i]);
+        func(array_elem(array, i));
+    }
+  }
+}
+
+
+int array_sort(struct array *array, array_cmp cmp, size_t nthreads) {
+  int rvalue = A_ERR;
+
+  if(array && cmp && array_linearize(array)) {
+    struct array_sort sort = { cmp, array_width(array), array->stride != 0 };
+    size_t count           = array->count;
+
+    if(count < 2)
+      return A_OK;
+
+    // Only use as many threads as there are chunks worth sorting
+    if(nthreads > ARRAY_SORT_THREADS)
+      nthreads = ARRAY_SORT_THREADS;
+
+    if(nthreads > count / ARRAY_SORT_MIN)
+      nthreads = count / ARRAY_SORT_MIN;
+
+    if(nthreads == 0)
+      nthreads = 1;
+
+    char *data = array_slot(array, 0);
+    char *tmp  = malloc(count * sort.width);
+
+    if(!tmp)
+      return rvalue;
+
+    struct array_sort_task tasks[ARRAY_SORT_THREADS];
+    size_t bounds[ARRAY_SORT_THREADS + 1];
+
+    // Each thread sorts an equal chunk in place
+    for(size_t i = 0; i <= nthreads; i++)
+      bounds[i] = count * i / nthreads;
+
+    for(size_t i = 0; i < nthreads; i++) {
+      tasks[i] = (struct array_sort_task){ &sort, data + bounds[i] * sort.width,
+        tmp + bounds[i] * sort.width, NULL, bounds[i + 1] - bounds[i], 0, 0, 0 };
+    }
+
+    array_sort_run(tasks, nthreads, array_sort_chunk);
+
+    // Merge neighbouring chunks in rounds, splitting every merge into
+    // equal pieces so that all threads stay busy to the last round
+    char *src = data;
+    char *dst = tmp;
+
+    for(size_t runs = nthreads; runs > 1; runs = (runs + 1) / 2) {
+      size_t pairs  = (runs + 1) / 2;
+      size_t pieces = nthreads / pairs;
+      size_t ntasks = 0;
+
+      for(size_t p = 0; p < pairs; p++) {
+        size_t lo  = bounds[p * 2];
+        size_t mid = bounds[p * 2 + 1];
+        size_t hi  = p * 2 + 2 <= runs ? bounds[p * 2 + 2] : mid;
+
+        for(size_t q = 0; q < pieces; q++) {
+          tasks[ntasks++] = (struct array_sort_task){ &sort, src + lo * sort.width,
+            src + mid * sort.width, dst + lo * sort.width, mid - lo, hi - mid,
+            (hi - lo) * q / pieces, (hi - lo) * (q + 1) / pieces };
+        }
+
+        bounds[p] = lo;
+      }
+
+      bounds[pairs] = count;
+      array_sort_run(tasks, ntasks, array_sort_piece);
+
+      char *swap = src;
+      src        = dst;
+      dst        = swap;
+    }
+
+    if(src != data)
+      memcpy(data, src, count * sort.width);
+
+    free(tmp);
+    rvalue = A_OK;
+  }
+
+  return rvalue;
+}
+
+
+int array_parallel_for_each(struct array *array, array_ctx_func func, void *ctx, size_t nthreads) {
+  int rvalue = A_ERR;
+
+  if(array && func) {
+    struct array_parallel job = { array, func, NULL, ctx, NULL, 0, array_parallel_chunks(array, nthreads) };
+
+    if(array->count == 0 || pool_run(pool_shared(), array_parallel_chunk, &job, job.chunks, nthreads))
+      rvalue = A_OK;
+  }
+
+  return rvalue;
+}
+
+
+int array_parallel_reduce(struct array *array, array_map_func map, array_reduce_func reduce, void *ctx, void *result, size_t size, size_t nthreads) {
+  int rvalue = A_ERR;
+
+  if(array && map && reduce && result && size) {
+    struct array_parallel job = { array, NULL, map, ctx, NULL, size, array_parallel_chunks(array, nthreads) };
+
+    if(array->count == 0)
+      return A_OK;
+
+    // Every chunk folds into its own partial, seeded with the identity
+    job.partials = malloc(job.chunks * size);
+
+    if(!job.partials)
+      return rvalue;
+
+    for(size_t i = 0; i < job.chunks; i++)
+      memcpy(job.partials + i * size, result, size);
+
+    if(pool_run(pool_shared(), array_parallel_chunk, &job, job.chunks, nthreads)) {
+      for(size_t i = 0; i < job.chunks; i++)
+        reduce(result, job.partials + i * size, ctx);
+
+      rvalue = A_OK;
     }
+
+    free(job.partials);
   }
+
+  return rvalue;
 }
 
 
@@ -205,7 +903,7 @@ void* array_front(struct array *array) {
 
   if(array) {
     if(array->data != NULL && array->count > 0) {
-      data = array->data[0];
+      data = array_elem(array, 0);
     }
   }
 
@@ -218,7 +916,7 @@ void* array_back(struct array *array) {
 
   if(array) {
     if(array->data != NULL && array->count > 0) {
-      data = array->data[array->count - 1];
+      data = array_elem(array, array->count - 1);
     }
   }
 
@@ -231,7 +929,7 @@ void* array_get(struct array *array, size_t pos) {
 
   if(array) {
     if(array->data != NULL && pos < array->count) {
-      data = array->data[pos];
+      data = array_elem(array, pos);
     }
   }
 
@@ -243,25 +941,14 @@ void* array_pop_beg(struct array *array) {
   void *data = NULL;
 
   if(array) {
-    if(array->data != NULL) {
-      // Assign our pointer to data
-      data = array->data[0];
-
-      // If there is more than one item move everything forward
-      if(array->count > 1) {
-        for(size_t i = 0; i < array->count; i++)
-          array->data[i] = array->data[i + 1];
-      }
+    if(array->data != NULL && array->count > 0) {
+      // Step head past the first item which keeps its slot until reused
+      data = array_elem(array, 0);
 
-      // Decrement the number of items
       --array->count;
 
-      if(array->count == 0) {
-        // If the array is now empty free memory
-        free(array->data);
-        array->data     = NULL;
-        array->capacity = 0;
-      }
+      if(++array->head == array->capacity || array->count == 0)
+        array->head = 0;
     }
   }
 
@@ -273,8 +960,9 @@ void* array_pop_end(struct array *array) {
   void *data = NULL;
 
   if(array) {
-    if(array->data != NULL) {
-      data = array->data[--array->count];
+    if(array->data != NULL && array->count > 0) {
+      // The vacated slot holds the item until the next modification
+      data = array_elem(array, --array->count);
     }
   }
 
@@ -293,15 +981,8 @@ void* array_pop_pos(struct array *array, size_t pos) {
       else if(pos == array->count - 1)
         return array_pop_end(array);
 
-      else if(pos < array->count) {
-        data = array->data[pos];
-
-        // Move all elements forward one space
-        for(size_t i = pos; i < array->count - 1; i++)
-          array->data[i] = array->data[i + 1];
-
-        --array->count; // Decrement the count
-      }
+      else if(pos < array->count)
+        data = array_remove(array, pos);
     }
   }
 
@@ -309,6 +990,24 @@ void* array_pop_pos(struct array *array, size_t pos) {
 }
 
 
+int array_stats(struct array *array, struct struct_stats *stats) {
+  int rvalue = A_ERR;
+
+  stats_clear(stats);
+
+#ifdef STATS_BUILD
+  if(array && stats) {
+    stats_merge(stats, &array->stats);
+    rvalue = A_OK;
+  }
+#else
+  (void)array;
+#endif
+
+  return rvalue;
+}
+
+
 size_t array_size(struct array *array) {
   size_t rvalue = 0;
 
@@ -324,7 +1023,7 @@ void array_print_as_string(struct array *array) {
   if(array) {
     if(array->data != NULL) {
       for(size_t i = 0; i < array->count; i++)
-        printf("%s", (char*)array->data[i]);
+        printf("%s", (char*)array_elem(array, i));
     }
   }
 }
@@ -0,0 +1,936 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - bench.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+
+
+#include <time.h>
+#include <sys/resource.h>
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// BENCH DESCRIPTION
+//
+// The bench executable times the array and heap operations over a
+// range of sizes and prints one row per measurement as CSV, or as
+// JSON when run with json as the second argument. The first argument
+// sets the largest size measured, which defaults to BENCH_MAX_SIZE;
+// pass 100000000 for the full sweep.
+//
+// Each row gives the mean nanoseconds per operation, the number of
+// allocations per operation made by the library and the peak resident
+// set size of the process so far. Allocations are only counted when
+// the bench is linked with malloc wrapped (BENCH_COUNT_ALLOCS).
+//
+// Operations that shift elements are timed over at most
+// BENCH_SHIFT_OPS calls at each size so that large sizes finish.
+//
+// The pqueue rows measure throughput with 1 up to BENCH_THREADS
+// threads each popping and re-adding at most BENCH_THREAD_OPS times on
+// a queue holding size elems. The variant names the mode and thread
+// count; mutex is a single shard, ie. one heap behind one lock. The
+// time per op is wall clock time over the ops of all threads.
+//
+// The array_sort rows sort random keys in pointer and inline arrays on
+// 1 up to BENCH_THREADS threads against qsort on a plain buffer.
+//
+// The typed variants time the same appends, adds and pops through the
+// containers generated by ARRAY_DEFINE and HEAP_DEFINE.
+//
+// The parallel rows apply BENCH_HASH_ROUNDS of hashing to every key
+// of an inline array, serially with array_for_each and on 1 up to
+// BENCH_THREADS threads with array_parallel_for_each, then sum the
+// hashes with array_parallel_reduce.
+//
+// The small variants time the heap_add, heap_mixed and heap_pop rows
+// on a heap created with heap_create_small, which keeps the 8 byte
+// payloads in the elems rather than allocating them.
+//
+// The minmax rows fill a MINMAXHEAP with size random keys and drain it
+// popping the min and the max in turn. The two heaps variant drains
+// the same keys from a min-heap and a max-heap holding a copy of every
+// key each, skipping keys already popped from the other heap.
+//
+// The heap_batch rows add and pop size keys in batches of BENCH_BATCH
+// with heap_add_n and heap_pop_n.
+//
+// The heap_topk rows keep the BENCH_TOPK largest of size random keys,
+// by pushing every key into a max-heap and popping the top ones, and
+// by offering every key to a bounded heap.
+//
+// The heap_reload rows time restoring a saved heap by adding back
+// every elem against mapping the file written by heap_save.
+//
+// The heap_merge rows time merging two heaps of size elems into one,
+// for the array heap and the pairing heap.
+//
+// The monotone rows pop the smallest key and add back a key no smaller
+// than it, as an event simulation would, on a binary heap and on the
+// radix heap.
+//
+// The queue_handoff rows pass items from one producer thread to one
+// consumer thread through a view array behind a mutex and through the
+// lock-free queue.
+
+
+/////////////////////////////////////////////////////////////
+// BENCH TYPES
+//
+
+#define BENCH_MIN_SIZE  100
+#define BENCH_MAX_SIZE  1000000
+#define BENCH_SHIFT_OPS 1000
+#define BENCH_THREADS    16
+#define BENCH_THREAD_OPS 100000
+#define BENCH_TOPK       100
+#define BENCH_BATCH      1000
+#define BENCH_HASH_ROUNDS 64
+
+enum bench_e {
+  B_CSV = 0, B_JSON
+};
+
+struct bench {
+  enum bench_e format;
+  size_t       rows;
+  double       start;
+  size_t       allocs;
+};
+
+struct bench_worker {
+  struct pqueue *queue;
+  size_t        size;
+  size_t        ops;
+  size_t        seed;
+};
+
+struct bench_handoff {
+  struct queue    *queue;
+  struct array    *array;
+  pthread_mutex_t lock;
+  size_t          ops;
+};
+
+
+/////////////////////////////////////////////////////////////
+// BENCH STATIC FUNCTIONS
+//
+
+static size_t bench_seed          = 88172645463325252ULL;
+static atomic_size_t bench_allocs = 0;
+
+
+#ifdef BENCH_COUNT_ALLOCS
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void *ptr, size_t size);
+
+
+void* __wrap_malloc(size_t size) {
+  atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+  return __real_malloc(size);
+}
+
+
+void* __wrap_calloc(size_t count, size_t size) {
+  atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+  return __real_calloc(count, size);
+}
+
+
+void* __wrap_realloc(void *ptr, size_t size) {
+  atomic_fetch_add_explicit(&bench_allocs, 1, memory_order_relaxed);
+  return __real_realloc(ptr, size);
+}
+
+#endif // BENCH_COUNT_ALLOCS
+
+
+static inline size_t bench_next(size_t *seed) {
+  // Xorshift keeps runs repeatable without touching rand()
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return *seed;
+}
+
+
+static inline size_t bench_rand() {
+  return bench_next(&bench_seed);
+}
+
+
+static inline double bench_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+
+static long bench_peak_rss() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss; // Kilobytes on Linux
+}
+
+
+static void bench_start(struct bench *bench) {
+  bench->allocs = bench_allocs;
+  bench->start  = bench_now();
+}
+
+
+static void bench_stop(struct bench *bench, const char *name, const char *variant, size_t size, size_t ops) {
+  double elapsed = bench_now() - bench->start;
+  size_t allocs  = bench_allocs - bench->allocs;
+
+  if(ops == 0)
+    ops = 1;
+
+#ifdef BENCH_COUNT_ALLOCS
+  double per_op = (double)allocs / ops;
+#else
+  double per_op = -1.0;
+#endif
+
+  if(bench->format == B_JSON) {
+    printf("%s\n  {\"bench\":\"%s\",\"variant\":\"%s\",\"size\":%zu,\"ops\":%zu,"
+      "\"ns_per_op\":%.2f,\"allocs_per_op\":%.3f,\"peak_rss_kb\":%ld}",
+      bench->rows ? "," : "[", name, variant, size, ops, elapsed / ops, per_op, bench_peak_rss());
+  } else {
+    if(bench->rows == 0)
+      printf("bench,variant,size,ops,ns_per_op,allocs_per_op,peak_rss_kb\n");
+
+    printf("%s,%s,%zu,%zu,%.2f,%.3f,%ld\n", name, variant, size, ops,
+      elapsed / ops, per_op, bench_peak_rss());
+  }
+
+  ++bench->rows;
+  fflush(stdout);
+}
+
+
+static struct array* bench_fill(struct array *array, size_t size) {
+  // Fill an array with keys without timing it
+  for(size_t i = 0; i < size; i++)
+    array_append(array, &i, sizeof(size_t));
+
+  return array;
+}
+
+
+static void* bench_pqueue_worker(void *arg) {
+  struct bench_worker *worker = arg;
+  struct elem elem;
+
+  // Keep the queue full, popping and adding back a later key
+  for(size_t i = 0; i < worker->ops; i++) {
+    size_t value = bench_next(&worker->seed) % worker->size;
+
+    if(pqueue_pop_into(worker->queue, &elem)) {
+      value += elem.value;
+      free(elem.data);
+    }
+
+    pqueue_add(worker->queue, &i, value, sizeof(size_t));
+  }
+
+  return NULL;
+}
+
+
+static void* bench_handoff_producer(void *arg) {
+  struct bench_handoff *handoff = arg;
+
+  // Any pointer other than NULL will do as the item
+  for(size_t i = 0; i < handoff->ops; i++) {
+    if(handoff->queue) {
+      while(!queue_push(handoff->queue, handoff))
+        sched_yield();
+    } else {
+      pthread_mutex_lock(&handoff->lock);
+      array_push_ptr(handoff->array, handoff);
+      pthread_mutex_unlock(&handoff->lock);
+    }
+  }
+
+  return NULL;
+}
+
+
+static void* bench_handoff_consumer(void *arg) {
+  struct bench_handoff *handoff = arg;
+
+  for(size_t i = 0; i < handoff->ops;) {
+    void *item = NULL;
+
+    if(handoff->queue) {
+      item = queue_pop(handoff->queue);
+    } else {
+      pthread_mutex_lock(&handoff->lock);
+      item = array_pop_beg(handoff->array);
+      pthread_mutex_unlock(&handoff->lock);
+    }
+
+    if(item)
+      ++i;
+    else
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+
+/////////////////////////////////////////////////////////////
+// BENCH FUNCTION DECLARATIONS
+//
+
+static void array_bench(struct bench *bench, size_t size) {
+  const char *variant[2] = { "pointer", "inline" };
+
+  for(size_t v = 0; v < 2; v++) {
+    size_t stride = v ? sizeof(size_t) : 0;
+    size_t shifts = size < BENCH_SHIFT_OPS ? size : BENCH_SHIFT_OPS;
+
+    // Time appending to an empty array
+    struct array *array = array_create_inline(0, stride);
+
+    bench_start(bench);
+    bench_fill(array, size);
+    bench_stop(bench, "array_append", variant[v], size, size);
+
+    // Time inserting into the middle of the array
+    bench_start(bench);
+
+    for(size_t i = 0; i < shifts; i++)
+      array_insert(array, array_size(array) / 2, &i, sizeof(size_t));
+
+    bench_stop(bench, "array_insert", variant[v], size, shifts);
+
+    // Time popping from the middle of the array
+    bench_start(bench);
+
+    for(size_t i = 0; i < shifts; i++) {
+      void *data = array_pop_pos(array, array_size(array) / 2);
+      if(!stride) free(data);
+    }
+
+    bench_stop(bench, "array_pop_pos", variant[v], size, shifts);
+
+    // Time draining the array from the front
+    bench_start(bench);
+
+    while(array_size(array)) {
+      void *data = array_pop_beg(array);
+      if(!stride) free(data);
+    }
+
+    bench_stop(bench, "array_pop_beg", variant[v], size, size);
+
+    // Time using the array as a queue which is kept full
+    bench_fill(array, size);
+    bench_start(bench);
+
+    for(size_t i = 0; i < size; i++) {
+      void *data = array_pop_beg(array);
+      if(!stride) free(data);
+      array_append(array, &i, sizeof(size_t));
+    }
+
+    bench_stop(bench, "array_queue", variant[v], size, size);
+    array_free(array);
+  }
+}
+
+
+static int bench_cmp(const void *a, const void *b) {
+  size_t ka = *(const size_t*)a, kb = *(const size_t*)b;
+  return (ka > kb) - (ka < kb);
+}
+
+
+static void sort_bench(struct bench *bench, size_t size) {
+  const char *variant[2] = { "pointer", "inline" };
+  size_t *keys           = malloc(sizeof(size_t) * size);
+  char name[32];
+
+  for(size_t i = 0; i < size; i++)
+    keys[i] = bench_rand();
+
+  // Time qsort on a copy of the keys as the baseline
+  size_t *copy = malloc(sizeof(size_t) * size);
+  memcpy(copy, keys, sizeof(size_t) * size);
+
+  bench_start(bench);
+  qsort(copy, size, sizeof(size_t), bench_cmp);
+  bench_stop(bench, "array_sort", "qsort", size, size);
+  free(copy);
+
+  for(size_t v = 0; v < 2; v++) {
+    for(size_t threads = 1; threads <= BENCH_THREADS; threads *= 2) {
+      struct array *array = array_create_inline(size, v ? sizeof(size_t) : 0);
+      array_append_n(array, keys, size, sizeof(size_t));
+
+      // Time sorting the same keys each time
+      bench_start(bench);
+      array_sort(array, bench_cmp, threads);
+
+      snprintf(name, sizeof(name), "%s/%zut", variant[v], threads);
+      bench_stop(bench, "array_sort", name, size, size);
+      array_free(array);
+    }
+  }
+
+  free(keys);
+}
+
+
+static void bench_hash(void *data) {
+  size_t *key = data;
+
+  // Stand in for a CPU heavy transform of each element
+  for(size_t i = 0; i < BENCH_HASH_ROUNDS; i++)
+    *key = bench_next(key);
+}
+
+
+static void bench_hash_ctx(void *data, void *ctx) {
+  bench_hash(data);
+  (void)ctx;
+}
+
+
+static void bench_sum_map(void *acc, void *data, void *ctx) {
+  *(size_t*)acc += *(size_t*)data;
+  (void)ctx;
+}
+
+
+static void bench_sum_reduce(void *acc, void *partial, void *ctx) {
+  *(size_t*)acc += *(size_t*)partial;
+  (void)ctx;
+}
+
+
+static void parallel_bench(struct bench *bench, size_t size) {
+  struct array *array = bench_fill(array_create_inline(size, sizeof(size_t)), size);
+  char name[32];
+
+  // Time the serial loop as the baseline
+  bench_start(bench);
+  array_for_each(array, bench_hash);
+  bench_stop(bench, "array_for_each", "serial", size, size);
+
+  for(size_t threads = 1; threads <= BENCH_THREADS; threads *= 2) {
+    snprintf(name, sizeof(name), "pool/%zut", threads);
+
+    bench_start(bench);
+    array_parallel_for_each(array, bench_hash_ctx, NULL, threads);
+    bench_stop(bench, "array_for_each", name, size, size);
+
+    size_t sum = 0;
+
+    bench_start(bench);
+    array_parallel_reduce(array, bench_sum_map, bench_sum_reduce, NULL, &sum, sizeof(size_t), threads);
+    bench_stop(bench, "array_reduce", name, size, size);
+  }
+
+  array_free(array);
+}
+
+
+static void heap_bench(struct bench *bench, size_t size) {
+  const char *variant[3] = { "2-ary", "4-ary", "8-ary" };
+  size_t arity[3]        = { 2, 4, 8 };
+
+  for(size_t a = 0; a < 3; a++) {
+    struct heap *heap = heap_create_ary(MINHEAP, arity[a], NULL);
+    struct elem elem;
+
+    // Time filling the heap with random keys
+    bench_start(bench);
+
+    for(size_t i = 0; i < size; i++)
+      heap_add(heap, &i, bench_rand(), sizeof(size_t));
+
+    bench_stop(bench, "heap_add", variant[a], size, size);
+
+    // Time popping and adding on a heap that stays full
+    bench_start(bench);
+
+    for(size_t i = 0; i < size; i++) {
+      heap_pop_into(heap, &elem);
+      free(elem.data);
+      heap_add(heap, &i, elem.value + (bench_rand() % size), sizeof(size_t));
+    }
+
+    bench_stop(bench, "heap_mixed", variant[a], size, size * 2);
+
+    // Time draining the heap again
+    bench_start(bench);
+
+    while(heap_size(heap)) {
+      struct elem *popped = heap_pop(heap);
+      heap_free_elem(popped);
+    }
+
+    bench_stop(bench, "heap_pop", variant[a], size, size);
+    heap_free(heap);
+  }
+
+  // Time building a heap from elems in one go
+  struct elem *elems = malloc(sizeof(struct elem) * size);
+
+  for(size_t i = 0; i < size; i++) {
+    elems[i].data  = malloc(sizeof(size_t));
+    elems[i].size  = sizeof(size_t);
+    elems[i].value = bench_rand();
+  }
+
+  bench_start(bench);
+  struct heap *heap = heap_from_elems(MINHEAP, elems, size);
+  bench_stop(bench, "heap_build", variant[0], size, size);
+
+  heap_free(heap);
+  free(elems);
+}
+
+
+static void small_bench(struct bench *bench, size_t size) {
+  struct heap *heap = heap_create_small(MINHEAP);
+  struct elem elem;
+
+  // Time filling the heap with random keys
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    heap_add(heap, &i, bench_rand(), sizeof(size_t));
+
+  bench_stop(bench, "heap_add", "small", size, size);
+
+  // Time popping and adding on a heap that stays full
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    heap_pop_into(heap, &elem);
+    heap_add(heap, &i, elem.value + (bench_rand() % size), sizeof(size_t));
+  }
+
+  bench_stop(bench, "heap_mixed", "small", size, size * 2);
+
+  // Time draining the heap again
+  bench_start(bench);
+
+  while(heap_size(heap)) {
+    struct elem *popped = heap_pop(heap);
+    heap_release_elem(heap, popped);
+  }
+
+  bench_stop(bench, "heap_pop", "small", size, size);
+  heap_free(heap);
+}
+
+
+static void minmax_bench(struct bench *bench, size_t size) {
+  struct heap *heap  = heap_create(MINMAXHEAP);
+  struct heap *lows  = heap_create(MINHEAP);
+  struct heap *highs = heap_create(MAXHEAP);
+  char *popped       = calloc(size, 1);
+  struct elem elem;
+
+  // Time filling the min-max heap with random keys
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    heap_add(heap, &i, bench_rand(), sizeof(size_t));
+
+  bench_stop(bench, "heap_add", "minmax", size, size);
+
+  // Time popping from alternate ends until it is empty
+  bench_start(bench);
+
+  for(size_t i = 0; heap_size(heap); i++) {
+    if(i % 2)
+      heap_pop_max(heap, &elem);
+    else
+      heap_pop_min(heap, &elem);
+
+    free(elem.data);
+  }
+
+  bench_stop(bench, "heap_pop_ends", "minmax", size, size);
+
+  // Time the same with a copy of each key in two heaps
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    size_t key = bench_rand();
+    heap_add(lows, &i, key, sizeof(size_t));
+    heap_add(highs, &i, key, sizeof(size_t));
+  }
+
+  bench_stop(bench, "heap_add", "two heaps", size, size);
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    struct heap *from = i % 2 ? highs : lows;
+
+    // Drop keys the other heap has already handed out
+    for(;;) {
+      heap_pop_into(from, &elem);
+      size_t id = *(size_t*)elem.data;
+      free(elem.data);
+
+      if(!popped[id]) {
+        popped[id] = 1;
+        break;
+      }
+    }
+  }
+
+  bench_stop(bench, "heap_pop_ends", "two heaps", size, size);
+
+  heap_free(heap);
+  heap_free(lows);
+  heap_free(highs);
+  free(popped);
+}
+
+
+ARRAY_DEFINE(size_t, key_array)
+HEAP_DEFINE(size_t, key_heap, TYPED_LESS)
+
+
+static void typed_bench(struct bench *bench, size_t size) {
+  struct key_array *array = key_array_create(0);
+  struct key_heap *heap   = key_heap_create(0);
+  size_t key              = 0;
+
+  // Time appending to an empty typed array
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    key_array_append(array, i);
+
+  bench_stop(bench, "array_append", "typed", size, size);
+
+  // Time filling and draining a typed heap
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    key_heap_add(heap, bench_rand());
+
+  bench_stop(bench, "heap_add", "typed", size, size);
+  bench_start(bench);
+
+  while(key_heap_pop(heap, &key))
+    continue;
+
+  bench_stop(bench, "heap_pop", "typed", size, size);
+
+  key_array_free(array);
+  key_heap_free(heap);
+}
+
+
+static void batch_bench(struct bench *bench, size_t size) {
+  struct heap *heap  = heap_create(MINHEAP);
+  struct elem *elems = malloc(sizeof(struct elem) * BENCH_BATCH);
+  size_t *keys       = malloc(sizeof(size_t) * BENCH_BATCH);
+
+  // Time filling the heap a batch at a time
+  bench_start(bench);
+
+  for(size_t done = 0; done < size; done += BENCH_BATCH) {
+    size_t count = size - done < BENCH_BATCH ? size - done : BENCH_BATCH;
+
+    for(size_t i = 0; i < count; i++) {
+      keys[i]  = bench_rand();
+      elems[i] = (struct elem){ &keys[i], sizeof(size_t), keys[i] };
+    }
+
+    heap_add_n(heap, elems, count);
+  }
+
+  bench_stop(bench, "heap_batch", "add_n", size, size);
+
+  // Time draining it a batch at a time
+  bench_start(bench);
+
+  while(heap_size(heap)) {
+    size_t count = heap_pop_n(heap, elems, BENCH_BATCH);
+
+    for(size_t i = 0; i < count; i++)
+      free(elems[i].data);
+  }
+
+  bench_stop(bench, "heap_batch", "pop_n", size, size);
+
+  heap_free(heap);
+  free(elems);
+  free(keys);
+}
+
+
+static void topk_bench(struct bench *bench, size_t size) {
+  struct elem top[BENCH_TOPK];
+  size_t seed = bench_seed;
+
+  // Time keeping the whole stream then popping the top
+  struct heap *heap = heap_create(MAXHEAP);
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    heap_add(heap, &i, bench_rand(), sizeof(size_t));
+
+  for(size_t i = 0; i < BENCH_TOPK && heap_size(heap); i++) {
+    heap_pop_into(heap, &top[i]);
+    free(top[i].data);
+  }
+
+  bench_stop(bench, "heap_topk", "maxheap", size, size);
+  heap_free(heap);
+
+  // Time offering the same stream to a bounded heap
+  heap       = heap_create_bounded(MINHEAP, BENCH_TOPK);
+  bench_seed = seed;
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++)
+    heap_offer(heap, &i, bench_rand(), sizeof(size_t));
+
+  size_t count = heap_drain_sorted(heap, top);
+  bench_stop(bench, "heap_topk", "bounded", size, size);
+
+  for(size_t i = 0; i < count; i++)
+    free(top[i].data);
+
+  heap_free(heap);
+}
+
+
+static void store_bench(struct bench *bench, size_t size) {
+  struct heap *heap = heap_create(MINHEAP);
+  struct elem elem;
+
+  for(size_t i = 0; i < size; i++)
+    heap_add(heap, &i, bench_rand(), sizeof(size_t));
+
+  heap_save(heap, "structs_bench.bin");
+
+  // Time rebuilding the heap one elem at a time
+  struct heap *copy = heap_create(MINHEAP);
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    elem = *(struct elem*)array_get(heap->array, i);
+    heap_add(copy, elem.data, elem.value, elem.size);
+  }
+
+  bench_stop(bench, "heap_reload", "heap_add", size, size);
+
+  // Time mapping the saved heap back in
+  bench_start(bench);
+  struct store *store = store_open("structs_bench.bin");
+  struct heap *loaded = heap_load(store);
+  bench_stop(bench, "heap_reload", "mmap", size, size);
+
+  heap_free(loaded);
+  store_close(store);
+  heap_free(copy);
+  heap_free(heap);
+  remove("structs_bench.bin");
+}
+
+
+static void merge_bench(struct bench *bench, size_t size) {
+  struct heap *heaps[2]   = { heap_create(MINHEAP), heap_create(MINHEAP) };
+  struct pheap *pheaps[2] = { pheap_create(MINHEAP), pheap_create(MINHEAP) };
+
+  for(size_t i = 0; i < size * 2; i++) {
+    size_t value = bench_rand();
+    heap_add(heaps[i % 2], &i, value, sizeof(size_t));
+    pheap_add(pheaps[i % 2], &i, value, sizeof(size_t));
+  }
+
+  // Time a single merge of two equal heaps
+  bench_start(bench);
+  heap_merge(heaps[0], heaps[1]);
+  bench_stop(bench, "heap_merge", "heap", size, 1);
+
+  bench_start(bench);
+  pheap_merge(pheaps[0], pheaps[1]);
+  bench_stop(bench, "heap_merge", "pairing", size, 1);
+
+  // Time draining the merged pairing heap for comparison with heap_pop
+  struct elem elem;
+  bench_start(bench);
+
+  while(pheap_pop_into(pheaps[0], &elem))
+    free(elem.data);
+
+  bench_stop(bench, "heap_pop", "pairing", size * 2, size * 2);
+
+  for(size_t i = 0; i < 2; i++) {
+    heap_free(heaps[i]);
+    pheap_free(pheaps[i]);
+  }
+}
+
+
+static void radix_bench(struct bench *bench, size_t size) {
+  struct heap *heap   = heap_create(MINHEAP);
+  struct radix *radix = radix_create();
+  struct elem elem;
+
+  for(size_t i = 0; i < size; i++) {
+    size_t value = bench_rand() % size;
+    heap_add(heap, &i, value, sizeof(size_t));
+    radix_add(radix, &i, value, sizeof(size_t));
+  }
+
+  // Time the same monotone workload on both
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    heap_pop_into(heap, &elem);
+    free(elem.data);
+    heap_add(heap, &i, elem.value + (bench_rand() % size), sizeof(size_t));
+  }
+
+  bench_stop(bench, "monotone_mixed", "heap", size, size * 2);
+  bench_start(bench);
+
+  for(size_t i = 0; i < size; i++) {
+    radix_pop_into(radix, &elem);
+    free(elem.data);
+    radix_add(radix, &i, elem.value + (bench_rand() % size), sizeof(size_t));
+  }
+
+  bench_stop(bench, "monotone_mixed", "radix", size, size * 2);
+  heap_free(heap);
+  radix_free(radix);
+}
+
+
+static void pqueue_bench(struct bench *bench, size_t size) {
+  const char *variant[3] = { "mutex", "strict", "relaxed" };
+  int mode[3]            = { P_STRICT, P_STRICT, P_RELAXED };
+  size_t ops             = size < BENCH_THREAD_OPS ? size : BENCH_THREAD_OPS;
+
+  for(size_t threads = 1; threads <= BENCH_THREADS; threads *= 2) {
+    for(size_t v = 0; v < 3; v++) {
+      struct pqueue *queue = pqueue_create(MINHEAP, v ? threads * 2 : 1, mode[v]);
+      struct bench_worker workers[BENCH_THREADS];
+      pthread_t ids[BENCH_THREADS];
+      char name[32];
+
+      for(size_t i = 0; i < size; i++)
+        pqueue_add(queue, &i, bench_rand(), sizeof(size_t));
+
+      // Time every thread working on the queue at once
+      bench_start(bench);
+
+      for(size_t i = 0; i < threads; i++) {
+        workers[i] = (struct bench_worker){ queue, size, ops, bench_rand() | 1 };
+        pthread_create(&ids[i], NULL, bench_pqueue_worker, &workers[i]);
+      }
+
+      for(size_t i = 0; i < threads; i++)
+        pthread_join(ids[i], NULL);
+
+      snprintf(name, sizeof(name), "%s/%zut", variant[v], threads);
+      bench_stop(bench, "pqueue_mixed", name, size, ops * threads * 2);
+      pqueue_free(queue);
+    }
+  }
+}
+
+
+static void queue_bench(struct bench *bench, size_t size) {
+  const char *variant[2] = { "mutex", "lockfree" };
+  size_t ops             = size < BENCH_THREAD_OPS ? size : BENCH_THREAD_OPS;
+
+  for(size_t v = 0; v < 2; v++) {
+    struct bench_handoff handoff;
+    pthread_t producer, consumer;
+
+    handoff.queue = v ? queue_create(1024) : NULL;
+    handoff.array = v ? NULL : array_create_view(1024);
+    handoff.ops   = ops;
+    pthread_mutex_init(&handoff.lock, NULL);
+
+    // Time one thread handing items to another
+    bench_start(bench);
+    pthread_create(&producer, NULL, bench_handoff_producer, &handoff);
+    pthread_create(&consumer, NULL, bench_handoff_consumer, &handoff);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    bench_stop(bench, "queue_handoff", variant[v], size, ops);
+
+    pthread_mutex_destroy(&handoff.lock);
+    queue_free(handoff.queue);
+    array_free(handoff.array);
+  }
+}
+
+
+/////////////////////////////////////////////////////////////
+// MAIN FUNCTION IMPLEMENTATION
+//
+
+int main(const int argc, const char *argv[]) {
+  struct bench bench = { B_CSV, 0, 0.0, 0 };
+  size_t max_size    = BENCH_MAX_SIZE;
+
+  if(argc > 1)
+    max_size = strtoull(argv[1], NULL, 10);
+
+  if(argc > 2 && strcmp(argv[2], "json") == 0)
+    bench.format = B_JSON;
+
+  // Sweep every benchmark across sizes growing tenfold
+  for(size_t size = BENCH_MIN_SIZE; size <= max_size; size *= 10) {
+    array_bench(&bench, size);
+    sort_bench(&bench, size);
+    parallel_bench(&bench, size);
+    heap_bench(&bench, size);
+    small_bench(&bench, size);
+    minmax_bench(&bench, size);
+    typed_bench(&bench, size);
+    batch_bench(&bench, size);
+    topk_bench(&bench, size);
+    store_bench(&bench, size);
+    merge_bench(&bench, size);
+    radix_bench(&bench, size);
+    pqueue_bench(&bench, size);
+    queue_bench(&bench, size);
+  }
+
+  if(bench.format == B_JSON)
+    printf("%s\n", bench.rows ? "\n]" : "[]");
+
+  return 0;
+}
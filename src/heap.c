@@ -24,18 +24,467 @@
 #include "structs.h"
 
 
+/////////////////////////////////////////////////////////////
+// HEAP STATIC FUNCTIONS
+//
+
+static inline struct elem* heap_elems(struct heap *heap) {
+  // Elements are stored by value in the inline array buffer
+  return (struct elem*)heap->array->data;
+}
+
+
+static inline size_t* heap_keys(struct heap *heap) {
+  // Priorities are mirrored in a dense array parallel to the elems
+  return (size_t*)heap->keys->data;
+}
+
+
+static inline size_t* heap_handles(struct heap *heap) {
+  // Handles of the elems at each position when the heap is indexed
+  return heap->handles ? (size_t*)heap->handles->data : NULL;
+}
+
+
+static inline void heap_track(struct heap *heap, size_t *handles, size_t index, size_t handle) {
+  // Record where the elem with the handle now sits
+  handles[index] = handle;
+  ((size_t*)heap->slots->data)[handle] = index;
+}
+
+
+static int heap_index(struct heap *heap) {
+  heap->handles = array_create_inline(0, sizeof(size_t));
+  heap->slots   = array_create_inline(0, sizeof(size_t));
+  heap->spare   = array_create_inline(0, sizeof(size_t));
+
+  // Existing elems are given handles matching their positions
+  if(heap->handles && heap->slots && heap->spare) {
+    size_t size = heap_size(heap);
+
+    if(array_reserve(heap->handles, size) && array_reserve(heap->slots, size)) {
+      for(size_t i = 0; i < size; i++)
+        heap_track(heap, heap_handles(heap), i, i);
+
+      heap->handles->count = size;
+      heap->slots->count   = size;
+      return H_OK;
+    }
+  }
+
+  array_free(heap->handles);
+  array_free(heap->slots);
+  array_free(heap->spare);
+  heap->handles = heap->slots = heap->spare = NULL;
+  return H_ERR;
+}
+
+
+static void heap_give_handle(struct heap *heap, size_t handle) {
+  // Mark the handle as dead and keep it for reuse
+  ((size_t*)heap->slots->data)[handle] = HEAP_NONE;
+  array_append(heap->spare, &handle, sizeof(size_t));
+}
+
+
+static int heap_take_handle(struct heap *heap, size_t index, size_t *handle) {
+  // Reuse a released handle before minting a new one
+  if(array_size(heap->spare))
+    *handle = *(size_t*)array_pop_end(heap->spare);
+  else if(array_append(heap->slots, &index, sizeof(size_t)))
+    *handle = array_size(heap->slots) - 1;
+  else
+    return H_ERR;
+
+  if(!array_append(heap->handles, handle, sizeof(size_t))) {
+    heap_give_handle(heap, *handle);
+    return H_ERR;
+  }
+
+  heap_track(heap, heap_handles(heap), index, *handle);
+  return H_OK;
+}
+
+
+static inline size_t heap_time_start(struct hist *hist) {
+  // Only sampled calls read the clock
+  return (hist && hist_sample(hist)) ? hist_now() : 0;
+}
+
+
+static inline void heap_time_stop(struct hist *hist, size_t start) {
+  if(start)
+    hist_record(hist, hist_now() - start);
+}
+
+
+static inline int heap_inline(struct heap *heap, size_t size) {
+  // Small heaps keep payloads that fit a pointer in the elem itself
+  return (heap->flags & H_SMALL) && size <= sizeof(void*);
+}
+
+
+static inline size_t heap_block(struct heap *heap, size_t size) {
+  // Payload blocks of bounded heaps are rounded up to a power of two so
+  // that the size of an elem also tells how much room its block has
+  size_t block = ALLOC_ALIGN;
+
+  if(!heap->bound)
+    return size;
+
+  while(block < size)
+    block <<= 1;
+
+  return block;
+}
+
+
+static int heap_copy(struct heap *heap, struct elem *elem, void *data, size_t size) {
+  void *copy = NULL;
+
+  if(heap_inline(heap, size)) {
+    memcpy(&copy, data, size);
+  } else {
+    copy = allocator_alloc(heap->alloc, heap_block(heap, size));
+
+    if(!copy)
+      return H_ERR;
+
+    memcpy(copy, data, size);
+    STATS_ADD(heap, allocs, 1);
+  }
+
+  STATS_ADD(heap, bytes_copied, size);
+  elem->data = copy;
+  elem->size = size;
+
+  return H_OK;
+}
+
+
+static inline void heap_drop(struct heap *heap, struct elem *elem) {
+  // Inline payloads have no block of their own to release
+  if(!heap_inline(heap, elem->size))
+    allocator_release(heap->alloc, elem->data);
+}
+
+
+static inline int heap_before(struct heap *heap, size_t value1, size_t value2) {
+  // True when value1 belongs nearer the root than value2
+  if(heap->type == MAXHEAP)
+    return value1 > value2;
+
+  return value1 < value2;
+}
+
+
+static int heap_reserve(struct array *array, size_t size) {
+  // Grow geometrically so that repeated batches stay amortized
+  size_t capacity = (size_t)(array->capacity * array->growth);
+
+  if(size <= array->capacity)
+    return H_OK;
+
+  return array_reserve(array, size > capacity ? size : capacity);
+}
+
+
+static int heap_restore(struct heap *heap, size_t size) {
+  // Restore the heap after elems were appended from position size on.
+  // Sifting the new elems up beats rebuilding when only a few arrive
+  size_t total  = heap_size(heap);
+  size_t levels = 1;
+
+  for(size_t n = total; n > 1; n /= heap->arity)
+    ++levels;
+
+  if((total - size) * levels < total) {
+    for(size_t i = size; i < total; i++)
+      heap_heapify_up(heap, i);
+
+    return H_OK;
+  }
+
+  return heap_build(heap);
+}
+
+
+static void heap_extract(struct heap *heap, struct elem *elem) {
+  struct elem *elems = heap_elems(heap);
+  size_t *keys       = heap_keys(heap);
+  size_t size        = heap_size(heap) - 1;
+  size_t index       = 0;
+  size_t levels      = 0;
+  size_t start       = heap_time_start(heap->pop_hist);
+
+  *elem = elems[0];
+
+  // Sink the hole left by the root straight to a leaf, then drop the
+  // last elem into it and sift it up, which is usually a short way
+  for(;;) {
+    size_t child_index = (index * heap->arity) + 1;
+
+    if(child_index >= size)
+      break;
+
+    size_t last_index = child_index + heap->arity;
+    size_t best_index = child_index;
+
+    if(last_index > size)
+      last_index = size;
+
+    for(size_t i = child_index + 1; i < last_index; i++) {
+      if(heap_before(heap, keys[i], keys[best_index]))
+        best_index = i;
+    }
+
+    elems[index] = elems[best_index];
+    keys[index]  = keys[best_index];
+    index        = best_index;
+    ++levels;
+  }
+
+  heap->array->count = size;
+  heap->keys->count  = size;
+
+  STATS_ADD(heap, sifts, 1);
+  STATS_ADD(heap, sift_levels, levels);
+  STATS_MAX(heap, max_sift_levels, levels);
+
+  if(index < size) {
+    elems[index] = elems[size];
+    keys[index]  = keys[size];
+    heap_heapify_up(heap, index);
+  }
+
+  heap_time_stop(heap->pop_hist, start);
+}
+
+
+static inline int heap_min_level(size_t index) {
+  // The root's level holds minimums and the levels alternate below it
+  size_t level = 0;
+
+  for(size_t n = index + 1; n > 1; n >>= 1)
+    ++level;
+
+  return !(level & 1);
+}
+
+
+static inline int heap_level_before(int min, size_t value1, size_t value2) {
+  return min ? value1 < value2 : value1 > value2;
+}
+
+
+static size_t heap_minmax_climb(struct heap *heap, size_t index, int min) {
+  size_t *keys  = heap_keys(heap);
+  size_t levels = 0;
+
+  // Climb by grandparents which sit on the same kind of level
+  while(index > 2) {
+    size_t grand_index = (((index - 1) / 2) - 1) / 2;
+
+    if(!heap_level_before(min, keys[index], keys[grand_index]))
+      break;
+
+    heap_swap(heap, index, grand_index);
+    index = grand_index;
+    ++levels;
+  }
+
+  STATS_ADD(heap, sifts, 1);
+  STATS_ADD(heap, sift_levels, levels);
+  STATS_MAX(heap, max_sift_levels, levels);
+
+  return index;
+}
+
+
+static size_t heap_minmax_up(struct heap *heap, size_t index) {
+  size_t *keys = heap_keys(heap);
+
+  if(index == 0)
+    return index;
+
+  int min             = heap_min_level(index);
+  size_t parent_index = (index - 1) / 2;
+
+  // An elem beyond its parent belongs on the parent's kind of level
+  if(heap_level_before(!min, keys[index], keys[parent_index])) {
+    heap_swap(heap, index, parent_index);
+    return heap_minmax_climb(heap, parent_index, !min);
+  }
+
+  return heap_minmax_climb(heap, index, min);
+}
+
+
+static void heap_minmax_down(struct heap *heap, size_t index) {
+  size_t *keys  = heap_keys(heap);
+  size_t size   = heap_size(heap);
+  size_t levels = 0;
+
+  for(;;) {
+    int min            = heap_min_level(index);
+    size_t child_index = (index * 2) + 1;
+
+    if(child_index >= size)
+      break;
+
+    // Find the best of the children and grandchildren
+    size_t grand_index = (child_index * 2) + 1;
+    size_t last_index  = grand_index + 4;
+    size_t best_index  = child_index;
+
+    if(child_index + 1 < size && heap_level_before(min, keys[child_index + 1], keys[best_index]))
+      best_index = child_index + 1;
+
+    if(last_index > size)
+      last_index = size;
+
+    for(size_t i = grand_index; i < last_index; i++) {
+      if(heap_level_before(min, keys[i], keys[best_index]))
+        best_index = i;
+    }
+
+    if(!heap_level_before(min, keys[best_index], keys[index]))
+      break;
+
+    heap_swap(heap, index, best_index);
+    ++levels;
+
+    if(best_index < grand_index)
+      break;
+
+    // The elem may now be beyond the parent it sank below
+    size_t parent_index = (best_index - 1) / 2;
+
+    if(heap_level_before(min, keys[parent_index], keys[best_index]))
+      heap_swap(heap, best_index, parent_index);
+
+    index = best_index;
+  }
+
+  STATS_ADD(heap, sifts, 1);
+  STATS_ADD(heap, sift_levels, levels);
+  STATS_MAX(heap, max_sift_levels, levels);
+}
+
+
+static void heap_minmax_fix(struct heap *heap, size_t index) {
+  size_t *keys = heap_keys(heap);
+
+  // Settle an elem whose key changed in place, in whichever direction
+  if(index > 0) {
+    int min             = heap_min_level(index);
+    size_t parent_index = (index - 1) / 2;
+
+    if(heap_level_before(!min, keys[index], keys[parent_index])) {
+      // The parent comes down in its place and must sink from there
+      heap_swap(heap, index, parent_index);
+      heap_minmax_down(heap, index);
+      heap_minmax_climb(heap, parent_index, !min);
+      return;
+    }
+
+    if(heap_minmax_climb(heap, index, min) != index)
+      return;
+  }
+
+  heap_minmax_down(heap, index);
+}
+
+
+static size_t heap_end_index(struct heap *heap, int min) {
+  size_t size = heap_size(heap);
+
+  // The min of a min-max heap is the root and its max a child of it
+  if(size == 0 || (heap->type == (min ? MAXHEAP : MINHEAP) && size > 1))
+    return HEAP_NONE;
+
+  if(heap->type != MINMAXHEAP || min || size == 1)
+    return 0;
+
+  if(size == 2 || heap_keys(heap)[1] >= heap_keys(heap)[2])
+    return 1;
+
+  return 2;
+}
+
+
+static int heap_pop_at(struct heap *heap, size_t index, struct elem *elem) {
+  size_t last = heap_size(heap) - 1;
+
+  // Move the last elem into the hole and pop the wanted one
+  if(index < last)
+    heap_swap(heap, index, last);
+
+  *elem = *(struct elem*)array_pop_end(heap->array);
+  array_pop_end(heap->keys);
+
+  if(heap->handles)
+    heap_give_handle(heap, *(size_t*)array_pop_end(heap->handles));
+
+  heap_heapify_down(heap, index);
+
+  return H_OK;
+}
+
+
+static int heap_pop_ctx(void *ctx, struct elem *elem) {
+  // Adapts pop_into to the signature heap_pop_with calls
+  return heap_pop_into(ctx, elem);
+}
+
+
 /////////////////////////////////////////////////////////////
 // HEAP FUNCTION IMPLEMENTATION
 //
 
 struct heap* heap_create(int type) {
+  return heap_create_alloc(type, NULL);
+}
+
+
+struct heap* heap_create_alloc(int type, struct allocator *alloc) {
+  return heap_create_ary(type, HEAP_ARITY, alloc);
+}
+
+
+struct heap* heap_create_ary(int type, size_t arity, struct allocator *alloc) {
+  // Every node needs at least two children to form a tree and the
+  // levels of a min-max heap only alternate with exactly two
+  if(arity < 2 || (type == MINMAXHEAP && arity != 2))
+    return NULL;
+
   struct heap *heap = malloc(sizeof(struct heap));
 
   if(heap) {
-    heap->array = array_create(0);
+    heap->array = array_create_alloc(0, sizeof(struct elem), alloc);
+    heap->keys  = array_create_inline(0, sizeof(size_t));
     heap->type  = type;
+    heap->arity = arity;
+    heap->bound = 0;
+    heap->flags = 0;
+    heap->alloc = alloc;
+
+    // Handles are only tracked once one has been asked for
+    heap->handles = NULL;
+    heap->slots   = NULL;
+    heap->spare   = NULL;
+
+    // Latencies are only recorded once histograms are attached
+    heap->add_hist = NULL;
+    heap->pop_hist = NULL;
+
+#ifdef STATS_BUILD
+    stats_clear(&heap->stats);
+#endif
 
-    if(!heap->array) {
+    if(!heap->array || !heap->keys) {
+      array_free(heap->array);
+      array_free(heap->keys);
       free(heap);
       heap = NULL;
     }
@@ -45,22 +494,95 @@ struct heap* heap_create(int type) {
 }
 
 
+struct heap* heap_create_bounded(int type, size_t bound) {
+  struct heap *heap = NULL;
+
+  if(bound)
+    heap = heap_create_ary(type, HEAP_ARITY, NULL);
+
+  if(heap) {
+    heap->bound = bound;
+
+    // Take all the room the heap will need up front
+    if(!array_reserve(heap->array, bound) || !array_reserve(heap->keys, bound)) {
+      heap_free(heap);
+      heap = NULL;
+    }
+  }
+
+  return heap;
+}
+
+
+struct heap* heap_create_small(int type) {
+  struct heap *heap = heap_create(type);
+
+  if(heap)
+    heap->flags = H_SMALL;
+
+  return heap;
+}
+
+
+struct heap* heap_from_array(int type, struct array *array) {
+  struct heap *heap = NULL;
+
+  if(array && (array->stride == 0 || array->stride == sizeof(struct elem)))
+    heap = heap_create_ary(type, HEAP_ARITY, array->alloc);
+
+  if(heap) {
+    if(array->stride && array_linearize(array)) {
+      // Inline elems are already laid out as the heap needs them
+      array_free(heap->array);
+      heap->array = array;
+    } else if(!array->stride && array_reserve(heap->array, array->count)) {
+      // Copy the elems out of their blocks then free the blocks
+      for(size_t i = 0; i < array->count; i++)
+        array_append(heap->array, array_get(array, i), sizeof(struct elem));
+
+      array_free(array);
+    } else {
+      heap_free(heap);
+      return NULL;
+    }
+
+    if(!heap_build(heap)) {
+      heap_free(heap);
+      heap = NULL;
+    }
+  }
+
+  return heap;
+}
+
+
+struct heap* heap_from_elems(int type, struct elem *elems, size_t count) {
+  struct array *array = array_create_inline(count, sizeof(struct elem));
+
+  if(array && !array_append_n(array, elems, count, sizeof(struct elem))) {
+    array_free(array);
+    array = NULL;
+  }
+
+  return array ? heap_from_array(type, array) : NULL;
+}
+
+
 void heap_free(struct heap *heap) {
   if(heap) {
     if(heap->array) {
       if(heap_size(heap)) {
         // Free all owned data with elem structs
-        for(size_t i = 0; i < heap->array->count; i++) {
-          struct elem *elem = NULL;
-          elem = heap->array->data[i];
-
-          if(elem != NULL)
-            free(elem->data);
-        }
+        for(size_t i = 0; i < heap->array->count; i++)
+          heap_drop(heap, &heap_elems(heap)[i]);
       }
       // Free the array struct
       array_free(heap->array);
     }
+    array_free(heap->keys);
+    array_free(heap->handles);
+    array_free(heap->slots);
+    array_free(heap->spare);
     // Free the heap struct
     free(heap);
   }
@@ -75,32 +597,158 @@ void heap_free_elem(struct elem *elem) {
 }
 
 
+void heap_release_elem(struct heap *heap, struct elem *elem) {
+  if(heap && elem) {
+    heap_drop(heap, elem);
+    free(elem);
+  }
+}
+
+
+struct elem* heap_pop_with(heap_pop_func pop, void *source) {
+  struct elem *data = NULL;
+
+  if(pop) {
+    // Popped elems are handed to the caller in their own allocation,
+    // which comes from malloc as an allocator may be sized for payloads
+    data = malloc(sizeof(struct elem));
+
+    if(data && !pop(source, data)) {
+      free(data);
+      data = NULL;
+    }
+  }
+
+  return data;
+}
+
+
 int heap_add(struct heap *heap, void *data, size_t value, size_t size) {
+  return heap_add_handle(heap, data, value, size, NULL);
+}
+
+
+int heap_add_handle(struct heap *heap, void *data, size_t value, size_t size, size_t *handle) {
   int rvalue = 0;
 
   if(heap) {
-    struct elem *elem = malloc(sizeof(struct elem));
+    // Asking for a handle starts tracking them for every elem
+    if(handle && (heap->bound || (!heap->handles && !heap_index(heap))))
+      return rvalue;
+
+    size_t start = heap_time_start(heap->add_hist);
+
+    // Copy memory accross to the heap
+    struct elem elem = { NULL, size, value };
+
+    if(heap_copy(heap, &elem, data, size)) {
+      // The elem is copied by value into the heap array
+      size_t index = heap_size(heap);
+      size_t spare = HEAP_NONE;
+
+      rvalue = array_append(heap->array, &elem, sizeof(struct elem));
+
+      if(rvalue && !array_append(heap->keys, &value, sizeof(size_t))) {
+        array_pop_end(heap->array);
+        rvalue = H_ERR;
+      }
+
+      if(rvalue && heap->handles && !heap_take_handle(heap, index, &spare)) {
+        array_pop_end(heap->array);
+        array_pop_end(heap->keys);
+        rvalue = H_ERR;
+      }
+
+      if(!rvalue) {
+        heap_drop(heap, &elem);
+      } else {
+        if(handle)
+          *handle = spare;
+
+        heap_heapify_up(heap, index);
+      }
+    }
+
+    heap_time_stop(heap->add_hist, start);
+  }
+
+  return rvalue;
+}
+
+
+int heap_add_n(struct heap *heap, struct elem *elems, size_t count) {
+  int rvalue = H_ERR;
+
+  // The batch would have no way to return a handle for each elem
+  if(heap && (elems || !count) && !heap->handles) {
+    size_t size = heap_size(heap);
+    rvalue      = H_OK;
+
+    if(!heap_reserve(heap->array, size + count) || !heap_reserve(heap->keys, size + count))
+      return H_ERR;
+
+    // Copy the batch in behind the heap then restore it in one go
+    for(size_t i = 0; i < count && rvalue; i++) {
+      struct elem *elem = &heap_elems(heap)[size + i];
 
-    if(elem) {
-      // Copy memory accross to the heap
-      void *copy = calloc(1, size);
+      if(heap_copy(heap, elem, elems[i].data, elems[i].size)) {
+        elem->value               = elems[i].value;
+        heap_keys(heap)[size + i] = elems[i].value;
+      } else {
+        // Release the copies made so far
+        while(i--)
+          heap_drop(heap, &heap_elems(heap)[size + i]);
 
-      if(copy) {
-        memcpy(copy, data, size);
+        rvalue = H_ERR;
+      }
+    }
 
-        // Initialize variables
-        elem->data  = copy;
-        elem->size  = size;
-        elem->value = value;
+    if(rvalue) {
+      heap->array->count = size + count;
+      heap->keys->count  = size + count;
+      rvalue             = heap_restore(heap, size);
+    }
+  }
 
-        rvalue = array_append(heap->array, elem, sizeof(struct elem));
+  return rvalue;
+}
 
-        if(heap_size(heap) > 1)
-          heap_heapify_up(heap, heap_size(heap) - 1);
 
+int heap_offer(struct heap *heap, void *data, size_t value, size_t size) {
+  int rvalue = H_ERR;
 
+  if(heap) {
+    size_t count = heap_size(heap);
+
+    if(!heap->bound || count < heap->bound) {
+      rvalue = heap_add(heap, data, value, size);
+    } else if(heap_before(heap, heap_keys(heap)[0], value)) {
+      // The new elem beats the weakest kept so it takes the root's place
+      struct elem *root = &heap_elems(heap)[0];
+      struct elem elem  = *root;
+
+      // The root's payload block is reused when the new payload rounds
+      // up to the same block size, so no block's room is ever forgotten
+      if(heap_inline(heap, size) || heap_inline(heap, root->size)
+        || heap_block(heap, size) != heap_block(heap, root->size)) {
+        if((rvalue = heap_copy(heap, &elem, data, size)))
+          heap_drop(heap, root);
+      } else {
+        memcpy(elem.data, data, size);
+        STATS_ADD(heap, bytes_copied, size);
+        elem.size = size;
+        rvalue    = H_OK;
       }
-      free(elem);
+
+      if(rvalue) {
+        elem.value         = value;
+        *root              = elem;
+        heap_keys(heap)[0] = value;
+
+        heap_heapify_down(heap, 0);
+      }
+    } else {
+      rvalue = H_REJECT;
     }
   }
 
@@ -113,11 +761,24 @@ int heap_swap(struct heap *heap, size_t elem1, size_t elem2) {
 
   if(heap) {
     if(heap_size(heap) > elem1 && heap_size(heap) > elem2) {
-      // Switch the pointers out using a temp pointer
-      void *temp = array_get(heap->array, elem1);
+      // Switch the elems and their keys out using temps
+      struct elem *elems = heap_elems(heap);
+      size_t *keys       = heap_keys(heap);
+      size_t *handles    = heap_handles(heap);
+      struct elem temp   = elems[elem1];
+      size_t key         = keys[elem1];
+
+      elems[elem1] = elems[elem2];
+      elems[elem2] = temp;
+      keys[elem1]  = keys[elem2];
+      keys[elem2]  = key;
+
+      if(handles) {
+        size_t handle = handles[elem1];
+        heap_track(heap, handles, elem1, handles[elem2]);
+        heap_track(heap, handles, elem2, handle);
+      }
 
-      heap->array->data[elem1] = heap->array->data[elem2];
-      heap->array->data[elem2] = temp;
       rvalue = H_OK;
     }
   }
@@ -126,39 +787,187 @@ int heap_swap(struct heap *heap, size_t elem1, size_t elem2) {
 }
 
 
+int heap_update_key(struct heap *heap, size_t handle, size_t value) {
+  int rvalue = H_ERR;
+
+  if(heap) {
+    size_t index = heap_handle_index(heap, handle);
+
+    if(index != HEAP_NONE) {
+      size_t old = heap_keys(heap)[index];
+
+      heap_keys(heap)[index]        = value;
+      heap_elems(heap)[index].value = value;
+
+      // Move the elem whichever way its new priority points
+      if(heap->type == MINMAXHEAP)
+        heap_minmax_fix(heap, index);
+      else if(heap_before(heap, value, old))
+        heap_heapify_up(heap, index);
+      else
+        heap_heapify_down(heap, index);
+
+      rvalue = H_OK;
+    }
+  }
+
+  return rvalue;
+}
+
+
+int heap_remove(struct heap *heap, size_t handle, struct elem *elem) {
+  int rvalue = H_ERR;
+
+  if(heap) {
+    size_t index = heap_handle_index(heap, handle);
+
+    if(index != HEAP_NONE) {
+      size_t last = heap_size(heap) - 1;
+
+      // Move the last elem into the hole and pop the removed one
+      heap_swap(heap, index, last);
+
+      struct elem *removed = array_pop_end(heap->array);
+
+      if(elem)
+        *elem = *removed;
+      else
+        heap_drop(heap, removed);
+
+      array_pop_end(heap->keys);
+      array_pop_end(heap->handles);
+      heap_give_handle(heap, handle);
+
+      if(index < last && heap->type == MINMAXHEAP) {
+        heap_minmax_fix(heap, index);
+      } else if(index < last) {
+        heap_heapify_up(heap, index);
+        heap_heapify_down(heap, index);
+      }
+
+      rvalue = H_OK;
+    }
+  }
+
+  return rvalue;
+}
+
+
+size_t heap_handle_index(struct heap *heap, size_t handle) {
+  size_t rvalue = HEAP_NONE;
+
+  if(heap && heap->slots) {
+    if(handle < array_size(heap->slots))
+      rvalue = ((size_t*)heap->slots->data)[handle];
+  }
+
+  return rvalue;
+}
+
+
+int heap_build(struct heap *heap) {
+  int rvalue = H_ERR;
+
+  if(heap) {
+    size_t size = heap_size(heap);
+
+    // Rebuild the dense keys from the elems
+    if(!array_reserve(heap->keys, size))
+      return rvalue;
+
+    // Handles can only be kept if they still match the elems
+    if(heap->handles && array_size(heap->handles) != size)
+      return rvalue;
+
+    for(size_t i = 0; i < size; i++)
+      heap_keys(heap)[i] = heap_elems(heap)[i].value;
+
+    heap->keys->count = size;
+
+    // Sift down every parent from the bottom up in O(n)
+    if(size > 1) {
+      for(size_t i = ((size - 2) / heap->arity) + 1; i > 0; i--)
+        heap_heapify_down(heap, i - 1);
+    }
+
+    rvalue = H_OK;
+  }
+
+  return rvalue;
+}
+
+
+int heap_merge(struct heap *dst, struct heap *src) {
+  int rvalue = H_ERR;
+
+  // The payloads move across so both heaps must free them the same way
+  if(dst && src && dst != src && dst->type == src->type && dst->alloc == src->alloc
+    && dst->flags == src->flags && !dst->handles && !src->handles && !dst->bound && !src->bound) {
+    size_t size  = heap_size(dst);
+    size_t count = heap_size(src);
+
+    if(count == 0)
+      return H_OK;
+
+    if(!array_append_n(dst->array, heap_elems(src), count, sizeof(struct elem)))
+      return rvalue;
+
+    if(!array_append_n(dst->keys, heap_keys(src), count, sizeof(size_t))) {
+      dst->array->count = size;
+      return rvalue;
+    }
+
+    // src hands over its elems without freeing their payloads
+    src->array->count = 0;
+    src->keys->count  = 0;
+
+    rvalue = heap_restore(dst, size);
+  }
+
+  return rvalue;
+}
+
+
 void heap_heapify_up(struct heap *heap, size_t index) {
   if(heap) {
-    size_t size         = heap_size(heap);
-    size_t parent_index = (index - 1) / 2;
+    if(index < heap_size(heap) && heap->type == MINMAXHEAP) {
+      heap_minmax_up(heap, index);
+    } else if(index < heap_size(heap)) {
+      struct elem *elems = heap_elems(heap);
+      size_t *keys       = heap_keys(heap);
+      size_t *handles    = heap_handles(heap);
 
-    if(index < size && parent_index < size) {
-      size_t child_value  = heap_get_value(heap, index);
-      size_t parent_value = heap_get_value(heap, parent_index);
+      // Lift the elem out and move parents down into the hole
+      struct elem elem = elems[index];
+      size_t key       = keys[index];
+      size_t handle    = handles ? handles[index] : HEAP_NONE;
+      size_t levels    = 0;
 
-      switch(heap->type) {
-      case MINHEAP:
-        {
-          if(child_value < parent_value) {
-            heap_swap(heap, index, parent_index);
+      while(index > 0) {
+        size_t parent_index = (index - 1) / heap->arity;
 
-            if(parent_index > 0)
-              heap_heapify_up(heap, parent_index);
-          }
-        }
-        break;
-      case MAXHEAP:
-        {
-          if(parent_value < child_value) {
-            heap_swap(heap, index, parent_index);
-
-            if(parent_index > 0)
-              heap_heapify_up(heap, parent_index);
-          }
-        }
-        break;
-      default:
-        break;
-      };
+        if(!heap_before(heap, key, keys[parent_index]))
+          break;
+
+        elems[index] = elems[parent_index];
+        keys[index]  = keys[parent_index];
+
+        if(handles)
+          heap_track(heap, handles, index, handles[parent_index]);
+
+        index = parent_index;
+        ++levels;
+      }
+
+      elems[index] = elem;
+      keys[index]  = key;
+
+      if(handles)
+        heap_track(heap, handles, index, handle);
+
+      STATS_ADD(heap, sifts, 1);
+      STATS_ADD(heap, sift_levels, levels);
+      STATS_MAX(heap, max_sift_levels, levels);
     }
   }
 }
@@ -168,54 +977,59 @@ void heap_heapify_down(struct heap *heap, size_t index) {
   if(heap) {
     size_t size = heap_size(heap);
 
-    if(size > 1) {
-      // Obtain the parent node and calculate indexes
-      size_t parent_value = heap_get_value(heap, index);
-      size_t left_index   = (index * 2) + 1;
-      size_t left_value   = heap_get_value(heap, left_index);
-      size_t right_index  = left_index + 1;
-      size_t right_value  = heap_get_value(heap, right_index);
-
-      // Helper vars for recursion
-      size_t swapped       = 0;
-      size_t swapped_index = parent_value;
-
-      switch(heap->type) {
-      case MINHEAP:
-        {
-          if(right_index < size && right_value < left_value && parent_value > right_value) {
-            heap_swap(heap, index, right_index);
-            swapped_index = right_index;
-            ++swapped;
-          }
-          else if(parent_value > left_value) {
-            heap_swap(heap, index, left_index);
-            swapped_index = left_index;
-            ++swapped;
-          }
-        }
-        break;
-      case MAXHEAP:
-        {
-          if(right_index < size && right_value > left_value && parent_value < right_value) {
-            heap_swap(heap, index, right_index);
-            swapped_index = right_index;
-            ++swapped;
-          }
-          else if(parent_value < size && parent_value < left_value) {
-            heap_swap(heap, index, left_index);
-            swapped_index = left_index;
-            ++swapped;
-          }
+    if(index < size && heap->type == MINMAXHEAP) {
+      heap_minmax_down(heap, index);
+    } else if(index < size) {
+      struct elem *elems = heap_elems(heap);
+      size_t *keys       = heap_keys(heap);
+      size_t *handles    = heap_handles(heap);
+
+      // Lift the elem out and move the best child up into the hole
+      struct elem elem = elems[index];
+      size_t key       = keys[index];
+      size_t handle    = handles ? handles[index] : HEAP_NONE;
+      size_t levels    = 0;
+
+      for(;;) {
+        size_t child_index = (index * heap->arity) + 1;
+
+        if(child_index >= size)
+          break;
+
+        // Find the best of the children which sit next to each other
+        size_t last_index = child_index + heap->arity;
+        size_t best_index = child_index;
+
+        if(last_index > size)
+          last_index = size;
+
+        for(size_t i = child_index + 1; i < last_index; i++) {
+          if(heap_before(heap, keys[i], keys[best_index]))
+            best_index = i;
         }
-        break;
-      default:
-        break;
-      };
 
-      if(swapped && ((swapped_index * 2) + 1) < size - 1)
-        heap_heapify_down(heap, swapped_index);
+        if(!heap_before(heap, keys[best_index], key))
+          break;
+
+        elems[index] = elems[best_index];
+        keys[index]  = keys[best_index];
+
+        if(handles)
+          heap_track(heap, handles, index, handles[best_index]);
 
+        index = best_index;
+        ++levels;
+      }
+
+      elems[index] = elem;
+      keys[index]  = key;
+
+      if(handles)
+        heap_track(heap, handles, index, handle);
+
+      STATS_ADD(heap, sifts, 1);
+      STATS_ADD(heap, sift_levels, levels);
+      STATS_MAX(heap, max_sift_levels, levels);
     }
   }
 }
@@ -230,45 +1044,57 @@ void heap_for_each(struct heap *heap, heap_func func) {
 }
 
 
-static void heap_print_nodes(struct heap *heap, struct array *string, struct array *padding, char *pointer, size_t index, size_t right_sibling) {
+int heap_parallel_for_each(struct heap *heap, heap_ctx_func func, void *ctx, size_t nthreads) {
+  int rvalue = H_ERR;
+
+  if(heap && array_parallel_for_each(heap->array, (array_ctx_func)func, ctx, nthreads))
+    rvalue = H_OK;
+
+  return rvalue;
+}
+
+
+static void heap_print_nodes(struct heap *heap, struct arena *arena, struct array *string, struct array *padding, char *pointer, size_t index, size_t sibling) {
   size_t size = heap_size(heap);
 
   if(size) {
     // Characters and Padding for convenience
     char *pad[5] = { "\n", "|  ", "   ", "├──", "└──" };
 
-    array_append(string, pad[0], sizeof(char) * strlen(pad[0]) + 1);
+    array_push_ptr(string, pad[0]);
     array_copy_from(string, padding, 0);
-    array_append(string, pointer, sizeof(char) + strlen(pointer));
+    array_push_ptr(string, pointer);
 
-    // Calculate the indices
-    size_t left_index   = (index * 2) + 1;
-    size_t right_index  = left_index + 1;
-    size_t node_value   = heap_get_value(heap, index);
+    // Calculate the indices of the children
+    size_t first_index = (index * heap->arity) + 1;
+    size_t last_index  = first_index + heap->arity;
+    size_t node_value  = heap_get_value(heap, index);
 
-    if(right_index > size) right_index = 0; // Set to 0 if the next
-    if(left_index > size) left_index   = 0; // node is not set
+    if(last_index > size) last_index = size; // Only print the children
+                                             // that have been set
+    // Print our node value to the arena
+    char *value = arena_alloc(arena, sizeof(char) * 32);
 
-    // Print our node value to string
-    char value[256];
-    snprintf(value, 256 * sizeof(char), "%zu", node_value);
-    array_append(string, value, sizeof(char) * 256);
+    if(value) {
+      snprintf(value, 32 * sizeof(char), "%zu", node_value);
+      array_push_ptr(string, value);
+    }
 
     // Construct the padding for this node
-    struct array *newpadding = array_create(0);
+    struct array *newpadding = array_create_view(0);
     array_copy_from(newpadding, padding, 0);
 
     // Assign padding
-    if(right_sibling)
-      array_append(newpadding, pad[1], sizeof(char) * strlen(pad[1]) + 1);
+    if(sibling)
+      array_push_ptr(newpadding, pad[1]);
     else
-      array_append(newpadding, pad[2], sizeof(char) * strlen(pad[2]) + 1);
+      array_push_ptr(newpadding, pad[2]);
 
     // Recursively print nodes
-    if(left_index)
-      heap_print_nodes(heap, string, newpadding, (right_index) ? pad[3] : pad[4], left_index, right_index);
-    if(right_index)
-      heap_print_nodes(heap, string, newpadding, pad[4], right_index, right_index);
+    for(size_t i = first_index; i < last_index; i++) {
+      size_t more = (i + 1 < last_index);
+      heap_print_nodes(heap, arena, string, newpadding, more ? pad[3] : pad[4], i, more);
+    }
 
     array_free(newpadding);
   }
@@ -280,23 +1106,30 @@ void heap_print(struct heap *heap) {
     size_t size = heap_size(heap);
 
     if(size) {
-      struct array *string  = array_create(0);
-      struct array *padding = array_create(0);
+      // The strings are views onto literals and node values which
+      // all come from one arena that is freed at once
+      struct arena *arena   = arena_create(0);
+      struct array *string  = array_create_view(0);
+      struct array *padding = array_create_view(0);
 
       // Add the relevant padding to our padding array
       char *pad[3]  = { "├──", "└──", "" };
-      array_append(padding, pad[2], sizeof(char));
+      array_push_ptr(padding, pad[2]);
 
       // Add the value of the root node to our string
       size_t rootval = heap_get_value(heap, 0);
-      char rv[256]   = "";
-      snprintf(rv, 256 * sizeof(char), "%zu", rootval);
-      array_append(string, rv, sizeof(char) * strnlen(rv, 256) + 1);
+      char *rv       = arena_alloc(arena, sizeof(char) * 32);
+
+      if(rv) {
+        snprintf(rv, 32 * sizeof(char), "%zu", rootval);
+        array_push_ptr(string, rv);
+      }
 
-      // Recursively explore the left and right nodes
-      if(size > 2)
-        heap_print_nodes(heap, string, padding, (3 < size) ? pad[0] : pad[1], 1, 1);
-      heap_print_nodes(heap, string, padding, pad[1], 2, 0);
+      // Recursively explore the children of the root
+      size_t last_index = (heap->arity < size) ? heap->arity + 1 : size;
+
+      for(size_t i = 1; i < last_index; i++)
+        heap_print_nodes(heap, arena, string, padding, (i + 1 < last_index) ? pad[0] : pad[1], i, i + 1 < last_index);
 
       // Print the tree to the screen
       if(string)
@@ -306,6 +1139,7 @@ void heap_print(struct heap *heap) {
       // Free memory for string and padding
       array_free(string);
       array_free(padding);
+      arena_free(arena);
     }
   }
 }
@@ -314,21 +1148,130 @@ void heap_print(struct heap *heap) {
 struct elem* heap_pop(struct heap *heap) {
   struct elem *data = NULL;
 
+  if(heap && heap_size(heap)) {
+    data = heap_pop_with(heap_pop_ctx, heap);
+    STATS_ADD(heap, allocs, 1);
+  }
+
+  return data;
+}
+
+
+int heap_pop_into(struct heap *heap, struct elem *elem) {
+  int rvalue = H_ERR;
+
+  if(heap && elem) {
+    size_t size  = heap_size(heap);
+    size_t start = heap_time_start(heap->pop_hist);
+
+    if(size)
+      rvalue = heap_pop_at(heap, 0, elem);
+
+    heap_time_stop(heap->pop_hist, start);
+  }
+
+  return rvalue;
+}
+
+
+int heap_pop_min(struct heap *heap, struct elem *elem) {
+  int rvalue = H_ERR;
+
+  if(heap && elem) {
+    size_t index = heap_end_index(heap, 1);
+    size_t start = heap_time_start(heap->pop_hist);
+
+    if(index != HEAP_NONE)
+      rvalue = heap_pop_at(heap, index, elem);
+
+    heap_time_stop(heap->pop_hist, start);
+  }
+
+  return rvalue;
+}
+
+
+int heap_pop_max(struct heap *heap, struct elem *elem) {
+  int rvalue = H_ERR;
+
+  if(heap && elem) {
+    size_t index = heap_end_index(heap, 0);
+    size_t start = heap_time_start(heap->pop_hist);
+
+    if(index != HEAP_NONE)
+      rvalue = heap_pop_at(heap, index, elem);
+
+    heap_time_stop(heap->pop_hist, start);
+  }
+
+  return rvalue;
+}
+
+
+struct elem* heap_peek_min(struct heap *heap) {
+  struct elem *elem = NULL;
+
   if(heap) {
-    size_t size = heap_size(heap);
-    if(size) {
-      // If there are othere elem move to end
-      if(size > 1)
-        heap_swap(heap, 0, size - 1);
+    size_t index = heap_end_index(heap, 1);
 
-      data = array_pop_end(heap->array); // Pop from end
+    if(index != HEAP_NONE)
+      elem = &heap_elems(heap)[index];
+  }
 
-      if((size - 1) > 1)
-        heap_heapify_down(heap, 0);
+  return elem;
+}
+
+
+struct elem* heap_peek_max(struct heap *heap) {
+  struct elem *elem = NULL;
+
+  if(heap) {
+    size_t index = heap_end_index(heap, 0);
+
+    if(index != HEAP_NONE)
+      elem = &heap_elems(heap)[index];
+  }
+
+  return elem;
+}
+
+
+size_t heap_pop_n(struct heap *heap, struct elem *elems, size_t count) {
+  size_t popped = 0;
+
+  if(heap && elems) {
+    if(count > heap_size(heap))
+      count = heap_size(heap);
+
+    // Handles have to follow every move and min-max levels alternate
+    // so both take the usual path
+    for(; (heap->handles || heap->type == MINMAXHEAP) && popped < count; popped++)
+      heap_pop_into(heap, &elems[popped]);
+
+    for(; popped < count; popped++)
+      heap_extract(heap, &elems[popped]);
+  }
+
+  return popped;
+}
+
+
+size_t heap_drain_sorted(struct heap *heap, struct elem *elems) {
+  size_t count = 0;
+
+  if(heap && elems) {
+    count = heap_size(heap);
+
+    // Pops come root first so fill the buffer from the back
+    for(size_t i = count; i > 0; i--) {
+      if(heap->handles || heap->type == MINMAXHEAP)
+        heap_pop_into(heap, &elems[i - 1]);
+      else
+        heap_extract(heap, &elems[i - 1]);
     }
   }
 
-  return data;
+  return count;
 }
 
 
@@ -337,9 +1280,60 @@ size_t       heap_get_value(struct heap *heap, size_t index) {
 
   if(heap) {
     if(index < heap_size(heap)) {
-      rvalue = ((struct elem*)array_get(heap->array, index))->value;
+      rvalue = heap_keys(heap)[index];
+    }
+  }
+
+  return rvalue;
+}
+
+
+void* heap_elem_data(struct heap *heap, struct elem *elem) {
+  void *data = NULL;
+
+  if(heap && elem) {
+    // Inline payloads live in the bytes of the data field itself
+    if(heap_inline(heap, elem->size))
+      data = &elem->data;
+    else
+      data = elem->data;
+  }
+
+  return data;
+}
+
+
+void heap_attach_hist(struct heap *heap, struct hist *add_hist, struct hist *pop_hist) {
+  if(heap) {
+    heap->add_hist = add_hist;
+    heap->pop_hist = pop_hist;
+  }
+}
+
+
+int heap_stats(struct heap *heap, struct struct_stats *stats) {
+  int rvalue = H_ERR;
+
+  stats_clear(stats);
+
+#ifdef STATS_BUILD
+  if(heap && stats) {
+    struct array *arrays[5] = { heap->array, heap->keys, heap->handles, heap->slots, heap->spare };
+    struct struct_stats array_stat;
+
+    // Combine the heap's own counters with those of its arrays
+    stats_merge(stats, &heap->stats);
+
+    for(size_t i = 0; i < 5; i++) {
+      if(array_stats(arrays[i], &array_stat))
+        stats_merge(stats, &array_stat);
     }
+
+    rvalue = H_OK;
   }
+#else
+  (void)heap;
+#endif
 
   return rvalue;
 }
@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - hist.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HIST_RDTSC
+#endif
+
+
+/////////////////////////////////////////////////////////////
+// HIST STATIC FUNCTIONS
+//
+
+static inline size_t hist_clock_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (size_t)ts.tv_sec * 1000000000 + (size_t)ts.tv_nsec;
+}
+
+
+static inline size_t hist_index(size_t value) {
+  // Small values get a bucket each
+  if(value < HIST_SUB)
+    return value;
+
+  // Otherwise pick the power of two then the linear sub-bucket in it
+  size_t exponent = (sizeof(size_t) * 8 - 1) - __builtin_clzll(value);
+  size_t sub      = (value >> (exponent - HIST_SUB_BITS)) & (HIST_SUB - 1);
+
+  return (exponent - HIST_SUB_BITS + 1) * HIST_SUB + sub;
+}
+
+
+static inline size_t hist_value(size_t index) {
+  // The largest value that falls in the bucket
+  if(index < HIST_SUB)
+    return index;
+
+  size_t exponent = (index / HIST_SUB) + HIST_SUB_BITS - 1;
+  size_t sub      = index % HIST_SUB;
+  size_t width    = (size_t)1 << (exponent - HIST_SUB_BITS);
+
+  return ((HIST_SUB + sub) * width) + width - 1;
+}
+
+
+/////////////////////////////////////////////////////////////
+// HIST FUNCTION IMPLEMENTATION
+//
+
+struct hist* hist_create(size_t sample) {
+  struct hist *hist = malloc(sizeof(struct hist));
+
+  if(hist) {
+    hist_clear(hist);
+    hist->sample = sample ? sample : 1;
+  }
+
+  return hist;
+}
+
+
+void hist_free(struct hist *hist) {
+  if(hist)
+    free(hist);
+}
+
+
+void hist_clear(struct hist *hist) {
+  if(hist) {
+    memset(hist->counts, 0, sizeof(hist->counts));
+    hist->total = 0;
+    hist->max   = 0;
+    hist->calls = 0;
+  }
+}
+
+
+size_t hist_now() {
+#ifdef HIST_RDTSC
+  return __rdtsc();
+#else
+  return hist_clock_ns();
+#endif
+}
+
+
+int hist_sample(struct hist *hist) {
+  int rvalue = 0;
+
+  // Time every sample'th call
+  if(hist)
+    rvalue = (hist->calls++ % hist->sample) == 0;
+
+  return rvalue;
+}
+
+
+void hist_record(struct hist *hist, size_t value) {
+  if(hist) {
+    ++hist->counts[hist_index(value)];
+    ++hist->total;
+
+    if(value > hist->max)
+      hist->max = value;
+  }
+}
+
+
+size_t hist_percentile(struct hist *hist, double percent) {
+  size_t rvalue = 0;
+
+  if(hist && hist->total) {
+    // Find the bucket holding the requested rank
+    size_t rank = (size_t)((percent / 100.0) * hist->total + 0.5);
+    size_t seen = 0;
+
+    if(rank == 0)
+      rank = 1;
+
+    for(size_t i = 0; i < HIST_BUCKETS; i++) {
+      seen += hist->counts[i];
+
+      if(seen >= rank) {
+        rvalue = hist_value(i);
+        break;
+      }
+    }
+
+    // Never report beyond the largest value recorded
+    if(rvalue > hist->max)
+      rvalue = hist->max;
+  }
+
+  return rvalue;
+}
+
+
+size_t hist_count(struct hist *hist) {
+  size_t rvalue = 0;
+
+  if(hist)
+    rvalue = hist->total;
+
+  return rvalue;
+}
+
+
+double hist_tick_ns() {
+  static double tick_ns = 0.0;
+
+#ifdef HIST_RDTSC
+  // Calibrate the time stamp counter against the clock once
+  if(tick_ns == 0.0) {
+    size_t ns    = hist_clock_ns();
+    size_t ticks = hist_now();
+
+    while(hist_clock_ns() - ns < 5000000);
+
+    tick_ns = (double)(hist_clock_ns() - ns) / (double)(hist_now() - ticks);
+  }
+#else
+  tick_ns = 1.0;
+#endif
+
+  return tick_ns;
+}
+
+
+void hist_print(struct hist *hist, const char *name) {
+  if(hist) {
+    double percent[6] = { 50.0, 90.0, 99.0, 99.9, 99.99, 100.0 };
+    double tick_ns    = hist_tick_ns();
+
+    printf("%s: count=%zu", name ? name : "hist", hist->total);
+
+    for(size_t i = 0; i < 6; i++)
+      printf(" p%g=%.0fns", percent[i], hist_percentile(hist, percent[i]) * tick_ns);
+
+    printf("\n");
+  }
+}
@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pheap.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// PHEAP STATIC FUNCTIONS
+//
+
+static inline int pheap_before(struct pheap *pheap, size_t value1, size_t value2) {
+  // True when value1 belongs nearer the root than value2
+  if(pheap->type == MAXHEAP)
+    return value1 > value2;
+
+  return value1 < value2;
+}
+
+
+static struct pnode* pheap_node(struct pheap *pheap) {
+  struct pnode *node = pheap->spare;
+
+  if(node) {
+    // Reuse a node from the free list
+    pheap->spare = node->sibling;
+
+    if(!pheap->spare)
+      pheap->spare_tail = NULL;
+  } else {
+    // A new or merged away heap starts a fresh arena, linked into the
+    // chain by a record carved from the arena itself
+    if(!pheap->arenas) {
+      struct arena *arena = arena_create(sizeof(struct pnode) * PHEAP_BLOCK);
+      struct parena *link = arena_alloc(arena, sizeof(struct parena));
+
+      if(!link) {
+        arena_free(arena);
+        return NULL;
+      }
+
+      link->arena        = arena;
+      link->next         = NULL;
+      pheap->arenas      = link;
+      pheap->arenas_tail = link;
+    }
+
+    node = arena_alloc(pheap->arenas->arena, sizeof(struct pnode));
+  }
+
+  return node;
+}
+
+
+static void pheap_give_node(struct pheap *pheap, struct pnode *node) {
+  node->sibling = pheap->spare;
+  pheap->spare  = node;
+
+  if(!pheap->spare_tail)
+    pheap->spare_tail = node;
+}
+
+
+static struct pnode* pheap_meld(struct pheap *pheap, struct pnode *a, struct pnode *b) {
+  // Link the root that loses under the one that wins
+  if(!a) return b;
+  if(!b) return a;
+
+  if(pheap_before(pheap, b->elem.value, a->elem.value)) {
+    struct pnode *temp = a;
+    a = b;
+    b = temp;
+  }
+
+  b->sibling = a->child;
+  a->child   = b;
+  return a;
+}
+
+
+static struct pnode* pheap_combine(struct pheap *pheap, struct pnode *first) {
+  struct pnode *pairs = NULL;
+
+  // First pass melds the children in pairs from left to right, stacking
+  // each result so the second pass sees them from right to left
+  while(first) {
+    struct pnode *a = first;
+    struct pnode *b = first->sibling;
+
+    first      = b ? b->sibling : NULL;
+    a->sibling = NULL;
+
+    if(b)
+      b->sibling = NULL;
+
+    struct pnode *pair = pheap_meld(pheap, a, b);
+    pair->sibling      = pairs;
+    pairs              = pair;
+  }
+
+  // Second pass melds the stacked pairs into a single tree
+  struct pnode *root = NULL;
+
+  while(pairs) {
+    struct pnode *next = pairs->sibling;
+    pairs->sibling     = NULL;
+    root               = pheap_meld(pheap, root, pairs);
+    pairs              = next;
+  }
+
+  return root;
+}
+
+
+static int pheap_pop_ctx(void *ctx, struct elem *elem) {
+  return pheap_pop_into(ctx, elem);
+}
+
+
+/////////////////////////////////////////////////////////////
+// PHEAP FUNCTION IMPLEMENTATION
+//
+
+struct pheap* pheap_create(int type) {
+  struct pheap *pheap = NULL;
+
+  if(type == MINHEAP || type == MAXHEAP)
+    pheap = malloc(sizeof(struct pheap));
+
+  if(pheap) {
+    pheap->root       = NULL;
+    pheap->spare      = NULL;
+    pheap->spare_tail  = NULL;
+    pheap->arenas      = NULL;
+    pheap->arenas_tail = NULL;
+    pheap->type        = type;
+    pheap->count       = 0;
+  }
+
+  return pheap;
+}
+
+
+void pheap_free(struct pheap *pheap) {
+  if(pheap) {
+    struct pnode *node = pheap->root;
+
+    // Free the payloads by walking the tree without recursion, moving
+    // each first child in front of its parent
+    while(node) {
+      if(node->child) {
+        struct pnode *child = node->child;
+        node->child         = child->sibling;
+        child->sibling      = node;
+        node                = child;
+      } else {
+        struct pnode *next = node->sibling;
+        free(node->elem.data);
+        node = next;
+      }
+    }
+
+    // The nodes themselves go with their arenas, and each link with
+    // the arena it was carved from
+    struct parena *link = pheap->arenas;
+
+    while(link) {
+      struct parena *next = link->next;
+      arena_free(link->arena);
+      link = next;
+    }
+
+    free(pheap);
+  }
+}
+
+
+int pheap_add(struct pheap *pheap, void *data, size_t value, size_t size) {
+  int rvalue = H_ERR;
+
+  if(pheap) {
+    struct pnode *node = pheap_node(pheap);
+
+    if(node) {
+      node->elem.data = malloc(size);
+
+      if(node->elem.data) {
+        memcpy(node->elem.data, data, size);
+        node->elem.size  = size;
+        node->elem.value = value;
+        node->child      = NULL;
+        node->sibling    = NULL;
+
+        pheap->root = pheap_meld(pheap, pheap->root, node);
+        ++pheap->count;
+        rvalue = H_OK;
+      } else {
+        pheap_give_node(pheap, node);
+      }
+    }
+  }
+
+  return rvalue;
+}
+
+
+int pheap_merge(struct pheap *dst, struct pheap *src) {
+  int rvalue = H_ERR;
+
+  if(dst && src && dst != src && dst->type == src->type) {
+    // The arenas holding the source nodes move across with them
+    if(src->arenas) {
+      if(dst->arenas_tail)
+        dst->arenas_tail->next = src->arenas;
+      else
+        dst->arenas = src->arenas;
+
+      dst->arenas_tail = src->arenas_tail;
+    }
+
+    // Splice the free lists together
+    if(src->spare) {
+      src->spare_tail->sibling = dst->spare;
+      dst->spare               = src->spare;
+
+      if(!dst->spare_tail)
+        dst->spare_tail = src->spare_tail;
+    }
+
+    dst->root   = pheap_meld(dst, dst->root, src->root);
+    dst->count += src->count;
+
+    src->root        = NULL;
+    src->spare       = NULL;
+    src->spare_tail  = NULL;
+    src->arenas      = NULL;
+    src->arenas_tail = NULL;
+    src->count       = 0;
+    rvalue           = H_OK;
+  }
+
+  return rvalue;
+}
+
+
+struct elem* pheap_pop(struct pheap *pheap) {
+  struct elem *data = NULL;
+
+  if(pheap && pheap->root)
+    data = heap_pop_with(pheap_pop_ctx, pheap);
+
+  return data;
+}
+
+
+int pheap_pop_into(struct pheap *pheap, struct elem *elem) {
+  int rvalue = H_ERR;
+
+  if(pheap && elem && pheap->root) {
+    struct pnode *root = pheap->root;
+    *elem              = root->elem;
+
+    pheap->root = pheap_combine(pheap, root->child);
+    pheap_give_node(pheap, root);
+    --pheap->count;
+    rvalue = H_OK;
+  }
+
+  return rvalue;
+}
+
+
+size_t pheap_get_value(struct pheap *pheap) {
+  return (pheap && pheap->root) ? pheap->root->elem.value : 0;
+}
+
+
+size_t pheap_size(struct pheap *pheap) {
+  return pheap ? pheap->count : 0;
+}
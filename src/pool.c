@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pool.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// POOL STATIC FUNCTIONS
+//
+
+static struct pool *pool_global         = NULL;
+static int pool_global_registered       = 0;
+static pthread_mutex_t pool_global_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void pool_work(struct pool *pool) {
+  size_t chunk;
+
+  // Take chunks until the job runs out of them
+  while((chunk = atomic_fetch_add(&pool->next, 1)) < pool->chunks)
+    pool->task(pool->ctx, chunk);
+}
+
+
+static void* pool_worker(void *arg) {
+  struct pool *pool = arg;
+
+  pthread_mutex_lock(&pool->lock);
+
+  // A new worker takes a seat in a job that is still open, such as the
+  // one whose pool_run started it
+  size_t seen = pool->generation;
+
+  if(pool->joined < pool->seats)
+    seen--;
+
+  while(!pool->stop) {
+    if(pool->generation != seen && pool->joined < pool->seats) {
+      seen = pool->generation;
+      pool->joined++;
+      pool->active++;
+
+      pthread_mutex_unlock(&pool->lock);
+      pool_work(pool);
+      pthread_mutex_lock(&pool->lock);
+
+      if(--pool->active == 0)
+        pthread_cond_signal(&pool->done);
+    } else {
+      seen = pool->generation;
+      pthread_cond_wait(&pool->work, &pool->lock);
+    }
+  }
+
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+
+static void pool_grow(struct pool *pool, size_t count) {
+  if(count > POOL_THREADS - 1)
+    count = POOL_THREADS - 1;
+
+  // Stop short if the system will not give us more threads
+  while(pool->count < count) {
+    if(pthread_create(&pool->threads[pool->count], NULL, pool_worker, pool))
+      break;
+
+    pool->count++;
+  }
+}
+
+
+/////////////////////////////////////////////////////////////
+// POOL FUNCTION IMPLEMENTATION
+//
+
+struct pool* pool_create(size_t nthreads) {
+  struct pool *pool = malloc(sizeof(struct pool));
+
+  if(pool) {
+    pthread_mutex_init(&pool->run, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    atomic_init(&pool->next, 0);
+
+    pool->count      = 0;
+    pool->task       = NULL;
+    pool->ctx        = NULL;
+    pool->chunks     = 0;
+    pool->seats      = 0;
+    pool->joined     = 0;
+    pool->active     = 0;
+    pool->generation = 0;
+    pool->stop       = 0;
+
+    // The thread running a job is one of its threads
+    if(nthreads > 1)
+      pool_grow(pool, nthreads - 1);
+  }
+
+  return pool;
+}
+
+
+struct pool* pool_shared(void) {
+  pthread_mutex_lock(&pool_global_lock);
+
+  if(!pool_global)
+    pool_global = pool_create(1);
+
+  // Join the workers at exit so that no thread or memory is left behind
+  if(pool_global && !pool_global_registered)
+    pool_global_registered = atexit(pool_shared_free) == 0;
+
+  struct pool *pool = pool_global;
+  pthread_mutex_unlock(&pool_global_lock);
+
+  return pool;
+}
+
+
+void pool_shared_free(void) {
+  pthread_mutex_lock(&pool_global_lock);
+  pool_free(pool_global);
+  pool_global = NULL;
+  pthread_mutex_unlock(&pool_global_lock);
+}
+
+
+void pool_free(struct pool *pool) {
+  if(pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(size_t i = 0; i < pool->count; i++)
+      pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run);
+    free(pool);
+  }
+}
+
+
+int pool_run(struct pool *pool, pool_task task, void *ctx, size_t chunks, size_t nthreads) {
+  int rvalue = T_ERR;
+
+  if(pool && task) {
+    if(nthreads > chunks)
+      nthreads = chunks;
+
+    if(nthreads > 1 && pthread_mutex_trylock(&pool->run) == 0) {
+      pool_grow(pool, nthreads - 1);
+
+      // Post the job and wake the workers to take their seats
+      pthread_mutex_lock(&pool->lock);
+      pool->task   = task;
+      pool->ctx    = ctx;
+      pool->chunks = chunks;
+      pool->seats  = nthreads - 1;
+      pool->joined = 0;
+      pool->generation++;
+      atomic_store(&pool->next, 0);
+      pthread_cond_broadcast(&pool->work);
+      pthread_mutex_unlock(&pool->lock);
+
+      pool_work(pool);
+
+      // Close the job to late workers and wait for those still in it
+      pthread_mutex_lock(&pool->lock);
+      pool->seats = 0;
+
+      while(pool->active)
+        pthread_cond_wait(&pool->done, &pool->lock);
+
+      pthread_mutex_unlock(&pool->lock);
+      pthread_mutex_unlock(&pool->run);
+    } else {
+      // A single thread or a busy pool runs the job here
+      for(size_t i = 0; i < chunks; i++)
+        task(ctx, i);
+    }
+
+    rvalue = T_OK;
+  }
+
+  return rvalue;
+}
+
+
+size_t pool_size(struct pool *pool) {
+  size_t rvalue = 0;
+
+  if(pool)
+    rvalue = pool->count;
+
+  return rvalue;
+}
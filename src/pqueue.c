@@ -0,0 +1,287 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - pqueue.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// PQUEUE STATIC FUNCTIONS
+//
+
+static _Thread_local size_t pqueue_seed = 0;
+
+
+static inline size_t pqueue_rand() {
+  // Each thread seeds from the address of its own seed
+  if(!pqueue_seed)
+    pqueue_seed = ((size_t)&pqueue_seed * 0x9E3779B97F4A7C15ULL) | 1;
+
+  pqueue_seed ^= pqueue_seed << 13;
+  pqueue_seed ^= pqueue_seed >> 7;
+  pqueue_seed ^= pqueue_seed << 17;
+  return pqueue_seed;
+}
+
+
+static inline int pqueue_before(struct pqueue *queue, size_t a, size_t b) {
+  return queue->type == MINHEAP ? a < b : a > b;
+}
+
+
+static inline void pqueue_publish(struct shard *shard) {
+  // Called with the shard locked after every change to its heap
+  size_t size = heap_size(shard->heap);
+
+  if(size)
+    atomic_store_explicit(&shard->top, heap_get_value(shard->heap, 0), memory_order_relaxed);
+
+  atomic_store_explicit(&shard->size, size, memory_order_release);
+}
+
+
+static struct shard* pqueue_lock_any(struct pqueue *queue) {
+  size_t index        = pqueue_rand() % queue->count;
+  struct shard *shard = NULL;
+
+  // Try each shard once before waiting on the last one
+  for(size_t i = 1; i < queue->count && !shard; i++) {
+    if(pthread_mutex_trylock(&queue->shards[index].lock) == 0)
+      shard = &queue->shards[index];
+    else
+      index = (index + 1) % queue->count;
+  }
+
+  if(!shard) {
+    shard = &queue->shards[index];
+    pthread_mutex_lock(&shard->lock);
+  }
+
+  return shard;
+}
+
+
+static struct shard* pqueue_choose(struct pqueue *queue) {
+  struct shard *a = &queue->shards[pqueue_rand() % queue->count];
+  struct shard *b = &queue->shards[pqueue_rand() % queue->count];
+
+  // Compare the published roots of two random shards
+  size_t size_a = atomic_load_explicit(&a->size, memory_order_acquire);
+  size_t size_b = atomic_load_explicit(&b->size, memory_order_acquire);
+
+  if(!size_a)
+    return size_b ? b : NULL;
+
+  if(!size_b)
+    return a;
+
+  size_t top_a = atomic_load_explicit(&a->top, memory_order_relaxed);
+  size_t top_b = atomic_load_explicit(&b->top, memory_order_relaxed);
+
+  return pqueue_before(queue, top_b, top_a) ? b : a;
+}
+
+
+static int pqueue_pop_shard(struct shard *shard, struct elem *elem) {
+  // Called with the shard locked
+  int rvalue = P_ERR;
+
+  if(heap_pop_into(shard->heap, elem)) {
+    pqueue_publish(shard);
+    rvalue = P_OK;
+  }
+
+  return rvalue;
+}
+
+
+static int pqueue_pop_strict(struct pqueue *queue, struct elem *elem) {
+  int rvalue         = P_ERR;
+  struct shard *best = NULL;
+
+  // Holding every lock at once gives the true root. Locks are always
+  // taken in index order so strict pops cannot deadlock each other
+  for(size_t i = 0; i < queue->count; i++) {
+    struct shard *shard = &queue->shards[i];
+    pthread_mutex_lock(&shard->lock);
+
+    if(heap_size(shard->heap) && (!best || pqueue_before(queue,
+      heap_get_value(shard->heap, 0), heap_get_value(best->heap, 0))))
+      best = shard;
+  }
+
+  if(best)
+    rvalue = pqueue_pop_shard(best, elem);
+
+  for(size_t i = queue->count; i-- > 0;)
+    pthread_mutex_unlock(&queue->shards[i].lock);
+
+  return rvalue;
+}
+
+
+static int pqueue_pop_relaxed(struct pqueue *queue, struct elem *elem) {
+  int rvalue = P_ERR;
+
+  // Give up on random choices once they keep landing on empty or
+  // busy shards
+  for(size_t tries = 0; tries < queue->count * 2 && rvalue == P_ERR; tries++) {
+    struct shard *shard = pqueue_choose(queue);
+
+    if(shard && pthread_mutex_trylock(&shard->lock) == 0) {
+      rvalue = pqueue_pop_shard(shard, elem);
+      pthread_mutex_unlock(&shard->lock);
+    }
+  }
+
+  // Sweep the shards so a queue that is not empty is never reported
+  // as empty
+  for(size_t i = 0; i < queue->count && rvalue == P_ERR; i++) {
+    struct shard *shard = &queue->shards[i];
+
+    if(atomic_load_explicit(&shard->size, memory_order_acquire)) {
+      pthread_mutex_lock(&shard->lock);
+      rvalue = pqueue_pop_shard(shard, elem);
+      pthread_mutex_unlock(&shard->lock);
+    }
+  }
+
+  return rvalue;
+}
+
+
+static int pqueue_pop_ctx(void *ctx, struct elem *elem) {
+  return pqueue_pop_into(ctx, elem);
+}
+
+
+/////////////////////////////////////////////////////////////
+// PQUEUE FUNCTION IMPLEMENTATION
+//
+
+struct pqueue* pqueue_create(int type, size_t shards, int mode) {
+  struct pqueue *queue = NULL;
+
+  if((type == MINHEAP || type == MAXHEAP) && (mode == P_STRICT || mode == P_RELAXED)) {
+    queue = malloc(sizeof(struct pqueue));
+
+    if(queue) {
+      if(shards == 0)
+        shards = 1;
+
+      // Each shard starts on its own cache line
+      queue->shards = aligned_alloc(PQUEUE_LINE, sizeof(struct shard) * shards);
+      queue->count  = 0;
+      queue->type   = type;
+      queue->mode   = mode;
+
+      for(size_t i = 0; queue->shards && i < shards; i++) {
+        struct shard *shard = &queue->shards[i];
+        shard->heap         = heap_create(type);
+
+        if(!shard->heap)
+          break;
+
+        pthread_mutex_init(&shard->lock, NULL);
+        atomic_init(&shard->size, 0);
+        atomic_init(&shard->top, 0);
+        ++queue->count;
+      }
+
+      if(queue->count != shards) {
+        pqueue_free(queue);
+        queue = NULL;
+      }
+    }
+  }
+
+  return queue;
+}
+
+
+void pqueue_free(struct pqueue *queue) {
+  if(queue) {
+    // Free the remaining elems along with each shard
+    for(size_t i = 0; i < queue->count; i++) {
+      pthread_mutex_destroy(&queue->shards[i].lock);
+      heap_free(queue->shards[i].heap);
+    }
+
+    free(queue->shards);
+    free(queue);
+  }
+}
+
+
+int pqueue_add(struct pqueue *queue, void *data, size_t value, size_t size) {
+  int rvalue = P_ERR;
+
+  if(queue && data) {
+    struct shard *shard = pqueue_lock_any(queue);
+
+    if(heap_add(shard->heap, data, value, size)) {
+      pqueue_publish(shard);
+      rvalue = P_OK;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+  }
+
+  return rvalue;
+}
+
+
+struct elem* pqueue_pop(struct pqueue *queue) {
+  struct elem *data = NULL;
+
+  if(queue)
+    data = heap_pop_with(pqueue_pop_ctx, queue);
+
+  return data;
+}
+
+
+int pqueue_pop_into(struct pqueue *queue, struct elem *elem) {
+  int rvalue = P_ERR;
+
+  if(queue && elem) {
+    if(queue->mode == P_STRICT)
+      rvalue = pqueue_pop_strict(queue, elem);
+    else
+      rvalue = pqueue_pop_relaxed(queue, elem);
+  }
+
+  return rvalue;
+}
+
+
+size_t pqueue_size(struct pqueue *queue) {
+  size_t rvalue = 0;
+
+  // The sum is only exact while no other thread is changing the queue
+  if(queue) {
+    for(size_t i = 0; i < queue->count; i++)
+      rvalue += atomic_load_explicit(&queue->shards[i].size, memory_order_acquire);
+  }
+
+  return rvalue;
+}
@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - queue.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// QUEUE FUNCTION IMPLEMENTATION
+//
+
+struct queue* queue_create(size_t size) {
+  struct queue *queue = NULL;
+
+  // Round the capacity up to a power of two so positions wrap by mask
+  size_t capacity = 2;
+
+  while(capacity < size)
+    capacity <<= 1;
+
+  queue = aligned_alloc(QUEUE_LINE, sizeof(struct queue));
+
+  if(queue) {
+    queue->array = array_create_inline(capacity, sizeof(struct cell));
+    queue->mask  = capacity - 1;
+
+    // Every cell starts free for the position it is first used at
+    struct cell cell = { 0, NULL };
+
+    for(size_t i = 0; queue->array && i < capacity; i++) {
+      if(!array_append(queue->array, &cell, sizeof(struct cell)))
+        break;
+    }
+
+    if(queue->array && array_size(queue->array) == capacity) {
+      queue->cells = array_get(queue->array, 0);
+
+      for(size_t i = 0; i < capacity; i++)
+        atomic_init(&queue->cells[i].seq, i);
+
+      atomic_init(&queue->tail, 0);
+      atomic_init(&queue->head, 0);
+    } else {
+      array_free(queue->array);
+      free(queue);
+      queue = NULL;
+    }
+  }
+
+  return queue;
+}
+
+
+void queue_free(struct queue *queue) {
+  if(queue) {
+    array_free(queue->array);
+    free(queue);
+  }
+}
+
+
+int queue_push(struct queue *queue, void *data) {
+  int rvalue = Q_ERR;
+
+  if(queue && data) {
+    size_t pos        = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    struct cell *cell = NULL;
+
+    while(!cell) {
+      struct cell *next = &queue->cells[pos & queue->mask];
+      size_t seq        = atomic_load_explicit(&next->seq, memory_order_acquire);
+      intptr_t diff     = (intptr_t)seq - (intptr_t)pos;
+
+      if(diff == 0) {
+        // The cell is free for this position so try to claim it
+        if(atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+          memory_order_relaxed, memory_order_relaxed))
+          cell = next;
+      } else if(diff < 0) {
+        // The cell still holds the item from a lap ago so we are full
+        break;
+      } else {
+        pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+      }
+    }
+
+    if(cell) {
+      cell->data = data;
+      atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+      rvalue = Q_OK;
+    }
+  }
+
+  return rvalue;
+}
+
+
+void* queue_pop(struct queue *queue) {
+  void *data = NULL;
+
+  if(queue) {
+    size_t pos        = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    struct cell *cell = NULL;
+
+    while(!cell) {
+      struct cell *next = &queue->cells[pos & queue->mask];
+      size_t seq        = atomic_load_explicit(&next->seq, memory_order_acquire);
+      intptr_t diff     = (intptr_t)seq - (intptr_t)(pos + 1);
+
+      if(diff == 0) {
+        // The cell has been filled for this position so try to take it
+        if(atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+          memory_order_relaxed, memory_order_relaxed))
+          cell = next;
+      } else if(diff < 0) {
+        // The cell has not been filled yet so we are empty
+        break;
+      } else {
+        pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+      }
+    }
+
+    if(cell) {
+      data = cell->data;
+
+      // Free the cell for the push one lap ahead
+      atomic_store_explicit(&cell->seq, pos + queue->mask + 1, memory_order_release);
+    }
+  }
+
+  return data;
+}
+
+
+size_t queue_size(struct queue *queue) {
+  size_t rvalue = 0;
+
+  // The size is only exact while no other thread is using the queue
+  if(queue) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    rvalue = tail > head ? tail - head : 0;
+  }
+
+  return rvalue;
+}
+
+
+size_t queue_capacity(struct queue *queue) {
+  return queue ? queue->mask + 1 : 0;
+}
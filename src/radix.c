@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - radix.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// RADIX STATIC FUNCTIONS
+//
+
+static inline size_t radix_bucket(size_t last, size_t value) {
+  // Index of the highest bit that differs, counted from one
+  return value == last ? 0 : (sizeof(size_t) * 8) - __builtin_clzll(value ^ last);
+}
+
+
+static size_t radix_first(struct radix *radix) {
+  // Find the first bucket after bucket 0 holding elems
+  size_t index = 1;
+
+  while(index < RADIX_BUCKETS && !array_size(radix->buckets[index]))
+    ++index;
+
+  return index;
+}
+
+
+static size_t radix_smallest(struct array *bucket) {
+  size_t last = ((struct elem*)array_get(bucket, 0))->value;
+
+  for(size_t i = 1; i < array_size(bucket); i++) {
+    size_t value = ((struct elem*)array_get(bucket, i))->value;
+    if(value < last) last = value;
+  }
+
+  return last;
+}
+
+
+static int radix_redistribute(struct radix *radix) {
+  size_t index = radix_first(radix);
+
+  if(index < RADIX_BUCKETS) {
+    struct array *bucket = radix->buckets[index];
+    size_t size          = array_size(bucket);
+
+    // Its smallest value becomes the new last value
+    size_t last = radix_smallest(bucket);
+
+    // Every elem of the bucket now belongs to a lower one, so make room
+    // in those first and leave the elems where they are if that fails
+    size_t counts[RADIX_BUCKETS] = { 0 };
+
+    for(size_t i = 0; i < size; i++)
+      ++counts[radix_bucket(last, ((struct elem*)array_get(bucket, i))->value)];
+
+    for(size_t i = 0; i < index; i++) {
+      if(counts[i] && !array_reserve(radix->buckets[i], array_size(radix->buckets[i]) + counts[i]))
+        return R_ERR;
+    }
+
+    radix->last = last;
+
+    while(array_size(bucket)) {
+      struct elem *elem = array_pop_end(bucket);
+      array_append(radix->buckets[radix_bucket(last, elem->value)], elem, sizeof(struct elem));
+    }
+  }
+
+  return R_OK;
+}
+
+
+static int radix_pop_ctx(void *ctx, struct elem *elem) {
+  return radix_pop_into(ctx, elem);
+}
+
+
+/////////////////////////////////////////////////////////////
+// RADIX FUNCTION IMPLEMENTATION
+//
+
+struct radix* radix_create() {
+  struct radix *radix = malloc(sizeof(struct radix));
+
+  if(radix) {
+    int created  = 1;
+    radix->last  = 0;
+    radix->count = 0;
+
+    for(size_t i = 0; i < RADIX_BUCKETS; i++) {
+      radix->buckets[i] = array_create_inline(0, sizeof(struct elem));
+      if(!radix->buckets[i]) created = 0;
+    }
+
+    if(!created) {
+      radix_free(radix);
+      radix = NULL;
+    }
+  }
+
+  return radix;
+}
+
+
+void radix_free(struct radix *radix) {
+  if(radix) {
+    // Free the payloads of any elems left behind
+    for(size_t i = 0; i < RADIX_BUCKETS; i++) {
+      struct array *bucket = radix->buckets[i];
+
+      for(size_t j = 0; j < array_size(bucket); j++)
+        free(((struct elem*)array_get(bucket, j))->data);
+
+      array_free(bucket);
+    }
+
+    free(radix);
+  }
+}
+
+
+int radix_add(struct radix *radix, void *data, size_t value, size_t size) {
+  int rvalue = R_ERR;
+
+  // Values below the last popped would break the bucket invariant
+  if(radix && value >= radix->last) {
+    struct elem elem = { malloc(size), size, value };
+
+    if(elem.data) {
+      memcpy(elem.data, data, size);
+
+      if(array_append(radix->buckets[radix_bucket(radix->last, value)], &elem, sizeof(struct elem))) {
+        ++radix->count;
+        rvalue = R_OK;
+      } else {
+        free(elem.data);
+      }
+    }
+  }
+
+  return rvalue;
+}
+
+
+struct elem* radix_pop(struct radix *radix) {
+  struct elem *data = NULL;
+
+  if(radix && radix->count)
+    data = heap_pop_with(radix_pop_ctx, radix);
+
+  return data;
+}
+
+
+int radix_pop_into(struct radix *radix, struct elem *elem) {
+  int rvalue = R_ERR;
+
+  if(radix && elem && radix->count) {
+    if(!array_size(radix->buckets[0]) && !radix_redistribute(radix))
+      return rvalue;
+
+    struct elem *popped = array_pop_end(radix->buckets[0]);
+
+    if(popped) {
+      *elem = *popped;
+      --radix->count;
+      rvalue = R_OK;
+    }
+  }
+
+  return rvalue;
+}
+
+
+size_t radix_get_value(struct radix *radix) {
+  size_t rvalue = 0;
+
+  // The smallest value is only known once bucket 0 is filled
+  if(radix && radix->count) {
+    // Without room to redistribute the smallest is found in place
+    if(array_size(radix->buckets[0]) || radix_redistribute(radix))
+      rvalue = radix->last;
+    else
+      rvalue = radix_smallest(radix->buckets[radix_first(radix)]);
+  }
+
+  return rvalue;
+}
+
+
+size_t radix_size(struct radix *radix) {
+  return radix ? radix->count : 0;
+}
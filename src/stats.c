@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - stats.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+
+/////////////////////////////////////////////////////////////
+// STATS FUNCTION IMPLEMENTATION
+//
+
+void stats_merge(struct struct_stats *dest, struct struct_stats *src) {
+  if(dest && src) {
+    dest->allocs       += src->allocs;
+    dest->reallocs     += src->reallocs;
+    dest->bytes_copied += src->bytes_copied;
+    dest->moves        += src->moves;
+    dest->sifts        += src->sifts;
+    dest->sift_levels  += src->sift_levels;
+
+    if(src->max_sift_levels > dest->max_sift_levels)
+      dest->max_sift_levels = src->max_sift_levels;
+  }
+}
+
+
+void stats_clear(struct struct_stats *stats) {
+  if(stats)
+    memset(stats, 0, sizeof(struct struct_stats));
+}
@@ -0,0 +1,399 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// structs - store.c
+//
+// Copyright (c) 2021 Christopher M. Short
+//
+// This file is part of structs.
+//
+// structs is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// structs is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with structs. If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "structs.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/////////////////////////////////////////////////////////////
+// STORE STATIC FUNCTIONS
+//
+
+static inline size_t store_align(size_t size) {
+  return (size + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1);
+}
+
+
+static void* store_alloc(void *ctx, size_t size) {
+  (void)ctx;
+  return malloc(size);
+}
+
+
+static void store_release(void *ctx, void *ptr) {
+  struct store *store = ctx;
+
+  // Memory inside the mapping is released along with it
+  if((char*)ptr < store->base || (char*)ptr >= store->base + store->bytes)
+    free(ptr);
+}
+
+
+static struct store_header store_header(int kind, size_t count, size_t stride) {
+  struct store_header header;
+
+  memset(&header, 0, sizeof(struct store_header));
+  memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+  header.version = STORE_VERSION;
+  header.kind    = kind;
+  header.width   = sizeof(void*);
+  header.count   = count;
+  header.stride  = stride;
+  header.slots   = store_align(sizeof(struct store_header));
+
+  return header;
+}
+
+
+static int store_write(FILE *file, size_t *offset, const void *data, size_t size) {
+  *offset += size;
+  return fwrite(data, 1, size, file) == size;
+}
+
+
+static int store_zero(FILE *file, size_t *offset, size_t size) {
+  static const char zeros[ALLOC_ALIGN];
+  int rvalue = S_OK;
+
+  for(size_t i = 0; i < size && rvalue; i += ALLOC_ALIGN)
+    rvalue = store_write(file, offset, zeros, size - i < ALLOC_ALIGN ? size - i : ALLOC_ALIGN);
+
+  return rvalue;
+}
+
+
+static int store_pad(FILE *file, size_t *offset) {
+  // Start the next section on an aligned offset
+  return store_zero(file, offset, store_align(*offset) - *offset);
+}
+
+
+static int store_finish(FILE *file, struct store_header *header, int rvalue) {
+  // Only write the header once the rest has been written in full
+  if(rvalue)
+    rvalue = fseek(file, 0, SEEK_SET) == 0 && fwrite(header, sizeof(struct store_header), 1, file) == 1;
+
+  if(fclose(file) != 0)
+    rvalue = S_ERR;
+
+  return rvalue;
+}
+
+
+static void store_map(struct store *store, struct array *array, size_t offset, size_t count) {
+  // Point an empty array at count slots of the mapping
+  if(array->data && !(array->flags & A_MAPPED))
+    free(array->data);
+
+  array->data     = (void**)(store->base + offset);
+  array->capacity = count;
+  array->count    = count;
+  array->head     = 0;
+  array->flags   |= A_MAPPED;
+}
+
+
+static int store_fits(struct store *store, size_t offset, size_t count, size_t width) {
+  // Check count slots of width and the spare slot after them lie within
+  // the file, dividing so that a crafted width cannot wrap the product
+  return width && offset <= store->bytes && count < (store->bytes - offset) / width;
+}
+
+
+static int store_after(struct store *store, size_t offset, size_t section, size_t count, size_t width) {
+  // Check offset lies within the file past a section that store_fits
+  // has already bounded, so the sum cannot wrap
+  return offset >= store_align(section + (count + 1) * width) && offset <= store->bytes;
+}
+
+
+static int store_ordered(struct heap *heap, struct elem *elems, size_t index, int min) {
+  // Check an elem against its parent and, on a min-max heap, against its
+  // grandparent, which between them order it after every ancestor
+  if(index == 0)
+    return S_OK;
+
+  size_t parent = (index - 1) / heap->arity;
+  size_t value  = elems[index].value;
+
+  if(heap->type == MINHEAP)
+    return elems[parent].value <= value;
+  else if(heap->type == MAXHEAP)
+    return elems[parent].value >= value;
+
+  // The parent sits on the other kind of level and the grandparent on
+  // the same kind as the elem
+  int rvalue = min ? elems[parent].value >= value : elems[parent].value <= value;
+
+  if(rvalue && parent)
+    rvalue = min ? elems[(parent - 1) / 2].value <= value : elems[(parent - 1) / 2].value >= value;
+
+  return rvalue;
+}
+
+
+/////////////////////////////////////////////////////////////
+// STORE FUNCTION IMPLEMENTATION
+//
+
+struct store* store_open(const char *path) {
+  struct store *store = NULL;
+  struct stat info;
+  int fd = path ? open(path, O_RDONLY) : -1;
+
+  if(fd >= 0 && fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(struct store_header)) {
+    store = malloc(sizeof(struct store));
+
+    if(store) {
+      // Map privately so that loaded structs may write to their pages
+      store->bytes = info.st_size;
+      store->base  = mmap(NULL, store->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+      store->allocator.alloc   = store_alloc;
+      store->allocator.release = store_release;
+      store->allocator.ctx     = store;
+
+      if(store->base == MAP_FAILED) {
+        free(store);
+        store = NULL;
+      }
+    }
+
+    if(store) {
+      struct store_header *header = (struct store_header*)store->base;
+
+      if(memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != STORE_VERSION || header->width != sizeof(void*)
+        || header->bytes != store->bytes) {
+        store_close(store);
+        store = NULL;
+      }
+    }
+  }
+
+  if(fd >= 0)
+    close(fd);
+
+  return store;
+}
+
+
+void store_close(struct store *store) {
+  if(store) {
+    munmap(store->base, store->bytes);
+    free(store);
+  }
+}
+
+
+int array_save(struct array *array, const char *path, store_size_func size) {
+  int rvalue = S_ERR;
+
+  if(array && path && (array->stride || size)) {
+    size_t count = array_size(array);
+    size_t width = array->stride ? array->stride : sizeof(void*);
+    size_t next  = 0;
+
+    struct store_header header = store_header(STORE_ARRAY, count, array->stride);
+    header.payload             = store_align(header.slots + (count + 1) * width);
+    header.bytes               = header.payload;
+
+    for(size_t i = 0; !array->stride && i < count; i++)
+      header.bytes += store_align(size(array_get(array, i)));
+
+    FILE *file = fopen(path, "wb");
+
+    if(file) {
+      size_t offset = 0;
+      rvalue        = store_zero(file, &offset, header.slots);
+
+      // Inline elements are written as they are, pointers as the offset
+      // of their payload, followed by the spare slot
+      next = header.payload;
+
+      for(size_t i = 0; i < count && rvalue; i++) {
+        if(array->stride) {
+          rvalue = store_write(file, &offset, array_get(array, i), array->stride);
+        } else {
+          rvalue = store_write(file, &offset, &next, sizeof(size_t));
+          next  += store_align(size(array_get(array, i)));
+        }
+      }
+
+      if(rvalue)
+        rvalue = store_zero(file, &offset, width) && store_pad(file, &offset);
+
+      for(size_t i = 0; !array->stride && i < count && rvalue; i++) {
+        void *data = array_get(array, i);
+        rvalue     = store_write(file, &offset, data, size(data)) && store_pad(file, &offset);
+      }
+
+      rvalue = store_finish(file, &header, rvalue && offset == header.bytes);
+    }
+  }
+
+  return rvalue;
+}
+
+
+struct array* array_load(struct store *store) {
+  struct array *array = NULL;
+
+  if(store) {
+    struct store_header *header = (struct store_header*)store->base;
+    size_t width                = header->stride ? header->stride : sizeof(void*);
+
+    if(header->kind == STORE_ARRAY && store_fits(store, header->slots, header->count, width)
+      && store_after(store, header->payload, header->slots, header->count, width))
+      array = array_create_alloc(0, header->stride, &store->allocator);
+
+    if(array && header->count) {
+      store_map(store, array, header->slots, header->count);
+
+      // Turn the payload offsets of pointer elements into pointers. The
+      // payloads were written in order, so each one must start no
+      // earlier than the last for it to end before the next begins, and
+      // before the end of the file for it to hold anything at all
+      size_t last = header->payload;
+
+      for(size_t i = 0; !header->stride && i < header->count; i++) {
+        size_t offset = (size_t)array->data[i];
+
+        if(offset < last || offset >= store->bytes) {
+          array->count = i;
+          array_free(array);
+          return NULL;
+        }
+
+        array->data[i] = store->base + offset;
+        last           = offset;
+      }
+    }
+  }
+
+  return array;
+}
+
+
+int heap_save(struct heap *heap, const char *path) {
+  int rvalue = S_ERR;
+
+  if(heap && path) {
+    size_t count = heap_size(heap);
+
+    struct store_header header = store_header(STORE_HEAP, count, sizeof(struct elem));
+    header.type                = heap->type;
+    header.arity               = heap->arity;
+    header.keys                = store_align(header.slots + (count + 1) * sizeof(struct elem));
+    header.payload             = store_align(header.keys + (count + 1) * sizeof(size_t));
+    header.bytes               = header.payload;
+
+    for(size_t i = 0; i < count; i++)
+      header.bytes += store_align(((struct elem*)array_get(heap->array, i))->size);
+
+    FILE *file = fopen(path, "wb");
+
+    if(file) {
+      size_t offset = 0;
+      size_t next   = header.payload;
+      rvalue        = store_zero(file, &offset, header.slots);
+
+      // Elems are written in heap order with their payload offsets
+      for(size_t i = 0; i < count && rvalue; i++) {
+        struct elem elem = *(struct elem*)array_get(heap->array, i);
+        elem.data        = (void*)next;
+        next            += store_align(elem.size);
+        rvalue           = store_write(file, &offset, &elem, sizeof(struct elem));
+      }
+
+      if(rvalue)
+        rvalue = store_zero(file, &offset, sizeof(struct elem)) && store_pad(file, &offset);
+
+      for(size_t i = 0; i < count && rvalue; i++)
+        rvalue = store_write(file, &offset, array_get(heap->keys, i), sizeof(size_t));
+
+      if(rvalue)
+        rvalue = store_zero(file, &offset, sizeof(size_t)) && store_pad(file, &offset);
+
+      for(size_t i = 0; i < count && rvalue; i++) {
+        struct elem *elem = array_get(heap->array, i);
+        rvalue            = store_write(file, &offset, heap_elem_data(heap, elem), elem->size) && store_pad(file, &offset);
+      }
+
+      rvalue = store_finish(file, &header, rvalue && offset == header.bytes);
+    }
+  }
+
+  return rvalue;
+}
+
+
+struct heap* heap_load(struct store *store) {
+  struct heap *heap = NULL;
+
+  if(store) {
+    struct store_header *header = (struct store_header*)store->base;
+
+    if(header->kind == STORE_HEAP && header->stride == sizeof(struct elem)
+      && (header->type == MINHEAP || header->type == MAXHEAP || header->type == MINMAXHEAP)
+      && store_fits(store, header->slots, header->count, sizeof(struct elem))
+      && store_fits(store, header->keys, header->count, sizeof(size_t))
+      && store_after(store, header->keys, header->slots, header->count, sizeof(struct elem))
+      && store_after(store, header->payload, header->keys, header->count, sizeof(size_t)))
+      heap = heap_create_ary(header->type, header->arity, &store->allocator);
+
+    if(heap && header->count) {
+      store_map(store, heap->array, header->slots, header->count);
+      store_map(store, heap->keys, header->keys, header->count);
+
+      // Turn the payload offsets back into pointers, refusing elems whose
+      // key was changed or that are out of heap order
+      struct elem *elems = (struct elem*)heap->array->data;
+      size_t *keys       = (size_t*)heap->keys->data;
+      int min            = 0;
+
+      for(size_t i = 0; i < header->count; i++) {
+        size_t offset = (size_t)elems[i].data;
+
+        // Levels of a min-max heap start at each power of two
+        if(((i + 1) & i) == 0)
+          min = !min;
+
+        if(offset < header->payload || offset > store->bytes || elems[i].size > store->bytes - offset
+          || keys[i] != elems[i].value || !store_ordered(heap, elems, i, min)) {
+          heap->array->count = 0;
+          heap_free(heap);
+          return NULL;
+        }
+
+        elems[i].data = store->base + offset;
+      }
+    }
+  }
+
+  return heap;
+}
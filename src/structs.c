@@ -107,10 +107,309 @@ static void heap_print_string(struct heap *heap, size_t row_len) {
 }
 
 
+static int compare_key(const void *a, const void *b) {
+  // Order pairs of size_t by their first member only
+  size_t ka = *(const size_t*)a, kb = *(const size_t*)b;
+  return (ka > kb) - (ka < kb);
+}
+
+
+static int compare_string(const void *a, const void *b) {
+  return strcmp(a, b);
+}
+
+
+static inline int string_before(const char *a, const char *b) {
+  return strcmp(a, b) > 0;
+}
+
+
+ARRAY_DEFINE(int, int_array)
+HEAP_DEFINE(size_t, key_heap, TYPED_LESS)
+HEAP_DEFINE(const char*, word_heap, string_before)
+
+
+static size_t string_size(void *data) {
+  return strlen(data) + 1;
+}
+
+
+static void store_patch(const char *path, size_t offset, uint64_t value) {
+  // Overwrite one field of a saved file to make it invalid
+  FILE *file = fopen(path, "r+b");
+
+  if(file) {
+    fseek(file, (long)offset, SEEK_SET);
+    fwrite(&value, sizeof(uint64_t), 1, file);
+    fclose(file);
+  }
+}
+
+
+static size_t store_field(const char *path, size_t offset) {
+  // Read one field of a saved file
+  uint64_t value = 0;
+  FILE *file     = fopen(path, "rb");
+
+  if(file) {
+    fseek(file, (long)offset, SEEK_SET);
+
+    if(fread(&value, sizeof(uint64_t), 1, file) != 1)
+      value = 0;
+
+    fclose(file);
+  }
+
+  return value;
+}
+
+
+static void store_cut(const char *path, size_t size) {
+  // Cut a saved file short
+  char *buffer = malloc(size);
+  FILE *file   = fopen(path, "rb");
+
+  if(buffer && file && fread(buffer, 1, size, file) == size) {
+    fclose(file);
+    file = fopen(path, "wb");
+
+    if(file)
+      fwrite(buffer, 1, size, file);
+  }
+
+  if(file)
+    fclose(file);
+
+  free(buffer);
+}
+
+
+static int store_refused(const char *path) {
+  // True when the saved file opens but its struct does not load
+  struct store *store = store_open(path);
+  int rvalue          = store && !array_load(store) && !heap_load(store);
+
+  store_close(store);
+
+  return rvalue;
+}
+
+
+static void* pqueue_worker(void *arg) {
+  struct pqueue *queue = arg;
+  struct elem elem;
+
+  // Add a thousand elems and pop half of them back
+  for(size_t i = 0; i < 1000; i++) {
+    pqueue_add(queue, &i, i, sizeof(size_t));
+
+    if(i % 2 && pqueue_pop_into(queue, &elem))
+      free(elem.data);
+  }
+
+  return NULL;
+}
+
+
+static void* queue_producer(void *arg) {
+  struct queue *queue = arg;
+  size_t *items       = malloc(sizeof(size_t) * 10000);
+
+  // Push numbered items, waiting whenever the queue is full
+  for(size_t i = 0; i < 10000; i++) {
+    items[i] = i + 1;
+
+    while(!queue_push(queue, &items[i]))
+      sched_yield();
+  }
+
+  return items;
+}
+
+
+static void* queue_consumer(void *arg) {
+  struct queue *queue = arg;
+  size_t *sum         = calloc(1, sizeof(size_t));
+
+  // Pop until a zero marks the end of the items
+  for(;;) {
+    size_t *item = queue_pop(queue);
+
+    if(!item)
+      sched_yield();
+    else if(*item == 0)
+      break;
+    else
+      *sum += *item;
+  }
+
+  return sum;
+}
+
+
+static void pool_count(void *ctx, size_t chunk) {
+  // Mark the chunk as run and add its index to the total
+  atomic_size_t *counts = ctx;
+  atomic_fetch_add(&counts[chunk + 1], 1);
+  atomic_fetch_add(&counts[0], chunk);
+}
+
+
+static void pool_nested(void *ctx, size_t chunk) {
+  // Each chunk posts a job of its own to the pool it is running on
+  struct pool *pool = ((void**)ctx)[0];
+  pool_run(pool, pool_count, ((void**)ctx)[1], 2, 4);
+  (void)chunk;
+}
+
+
+struct pool_spread {
+  pthread_mutex_t lock;
+  pthread_t ids[POOL_THREADS];
+  size_t    count;
+};
+
+
+static size_t pool_note(struct pool_spread *spread) {
+  // Record the running thread once and return how many have been seen
+  pthread_mutex_lock(&spread->lock);
+  size_t i = 0;
+
+  while(i < spread->count && !pthread_equal(spread->ids[i], pthread_self()))
+    i++;
+
+  if(i == spread->count)
+    spread->ids[spread->count++] = pthread_self();
+
+  i = spread->count;
+  pthread_mutex_unlock(&spread->lock);
+
+  return i;
+}
+
+
+static void pool_spread(void *ctx, size_t chunk) {
+  // Hold the chunk until a second thread has joined the job or we give up
+  for(size_t i = 0; i < 100000 && pool_note(ctx) < 2; i++)
+    sched_yield();
+
+  (void)chunk;
+}
+
+
+static void square_key(void *data, void *ctx) {
+  *(size_t*)data *= *(size_t*)data;
+  (void)ctx;
+}
+
+
+static void sum_map(void *acc, void *data, void *ctx) {
+  *(size_t*)acc += *(size_t*)data;
+  (void)ctx;
+}
+
+
+static void sum_reduce(void *acc, void *partial, void *ctx) {
+  *(size_t*)acc += *(size_t*)partial;
+  (void)ctx;
+}
+
+
+static void sum_elem(void *elem, void *ctx) {
+  atomic_fetch_add((atomic_size_t*)ctx, ((struct elem*)elem)->value);
+}
+
+
 /////////////////////////////////////////////////////////////
 // TEST FUNCTION DECLARATIONS
 //
 
+void alloc_tests() {
+  printf("|---------- ALLOC STRUCT TEST ----------|\n");
+  unsigned int t = 0;
+
+  // Test that arena allocations are aligned and distinct
+  struct arena *arena = arena_create(64);
+  char *ptr1 = arena_alloc(arena, 3);
+  char *ptr2 = arena_alloc(arena, 100);
+
+  if(ptr1 && ptr2 && ptr1 != ptr2 && ((size_t)ptr2 % ALLOC_ALIGN) == 0)
+    printf("TEST%u: Arena allocation\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Arena allocation\t\t[FAILURE]\n", ++t);
+
+  // Test that arrays can be backed by an arena
+  struct array *array1 = array_create_alloc(0, 0, arena_allocator(arena));
+  int success = 0;
+
+  for(int i = 0; i < 100; i++)
+    success += array_append(array1, &i, sizeof(int));
+
+  if(success == 100 && *(int*)array_back(array1) == 99)
+    printf("TEST%u: Arena backed array\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Arena backed array\t\t[FAILURE]\n", ++t);
+
+  array_free(array1);
+  arena_reset(arena);
+
+  if(arena->head && arena->head->next == NULL && arena->head->used == 0)
+    printf("TEST%u: Arena reset\t\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Arena reset\t\t\t[FAILURE]\n", ++t);
+
+  // Test that slabs reuse released objects
+  struct slab *slab = slab_create(sizeof(struct elem), 8);
+  void *obj1 = slab_alloc(slab);
+  slab_release(slab, obj1);
+
+  if(obj1 && slab_alloc(slab) == obj1)
+    printf("TEST%u: Slab reuse\t\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Slab reuse\t\t\t[FAILURE]\n", ++t);
+
+  // Test that heaps can be backed by a slab
+  struct heap *heap1 = heap_create_alloc(MINHEAP, slab_allocator(slab));
+  success = 0;
+
+  for(size_t i = 0; i < 20; i++)
+    success += heap_add(heap1, &i, 20 - i, sizeof(size_t));
+
+  struct elem *elem = heap_pop(heap1);
+
+  if(success == 20 && elem && elem->value == 1 && *(size_t*)elem->data == 19)
+    printf("TEST%u: Slab backed heap\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Slab backed heap\t\t[FAILURE]\n", ++t);
+
+  heap_release_elem(heap1, elem);
+  heap_free(heap1);
+
+  // Test a slab sized for the payloads alone still pops every elem
+  struct slab *slab2 = slab_create(sizeof(size_t), 8);
+  struct heap *heap2 = heap_create_alloc(MINHEAP, slab_allocator(slab2));
+
+  for(size_t i = 0; i < 20; i++)
+    heap_add(heap2, &i, 20 - i, sizeof(size_t));
+
+  for(size_t i = 1; success && i <= 20; i++) {
+    elem    = heap_pop(heap2);
+    success = elem && elem->value == i && *(size_t*)elem->data == 20 - i;
+    heap_release_elem(heap2, elem);
+  }
+
+  if(success && heap_size(heap2) == 0)
+    printf("TEST%u: Payload sized slab heap\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Payload sized slab heap\t[FAILURE]\n", ++t);
+
+  heap_free(heap2);
+  slab_free(slab2);
+  slab_free(slab);
+  arena_free(arena);
+}
+
+
 void array_tests() {
   printf("|---------- ARRAY STRUCT TEST ----------|\n");
   unsigned int t = 0;
@@ -220,11 +519,290 @@ void array_tests() {
 
   array_print_int(array4, 10);
 
+  // Test that inline arrays store elements contiguously
+  struct array *array5 = array_create_inline(0, sizeof(int));
+  success = 0;
+
+  for(int i = 0; i < 30; i++)
+    success += array_insert(array5, 1, &i, sizeof(int));
+
+  if(success == 30 && (int*)array_get(array5, 1) + 1 == (int*)array_get(array5, 2))
+    printf("TEST%u: Test inline insert 30 ints\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test inline insert 30 ints\t[FAILURE]\n", ++t);
+
+  array_print_int(array5, 10);
+
+  data = array_pop_beg(array5);
+
+  if(data && *(int*)data == 0 && *(int*)array_front(array5) == 29)
+    printf("TEST%u: Test inline pop front\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test inline pop front\t[FAILURE]\n", ++t);
+
+  data = array_pop_pos(array5, 10);
+
+  if(data && *(int*)data == 19 && array_size(array5) == 28)
+    printf("TEST%u: Test inline pop 10th item\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test inline pop 10th item\t[FAILURE]\n", ++t);
+
+  // Test reserving and bulk adding to arrays
+  struct array *array6 = array_create_inline(0, sizeof(int));
+  struct array *array7 = array_create(0);
+  int ints[100];
+
+  for(int i = 0; i < 100; i++)
+    ints[i] = i;
+
+  array_reserve(array6, 100);
+  size_t capacity = array6->capacity;
+
+  success  = array_append_n(array6, ints, 100, sizeof(int));
+  success += array_insert_range(array6, 50, ints, 10, sizeof(int));
+
+  if(success == 2 && capacity == 100 && array_size(array6) == 110
+    && *(int*)array_get(array6, 50) == 0 && *(int*)array_get(array6, 60) == 50)
+    printf("TEST%u: Test inline bulk append\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test inline bulk append\t[FAILURE]\n", ++t);
+
+  success  = array_append_n(array7, ints, 100, sizeof(int));
+  success += array_insert_range(array7, 0, &ints[90], 10, sizeof(int));
+
+  if(success == 2 && array_size(array7) == 110
+    && *(int*)array_front(array7) == 90 && *(int*)array_back(array7) == 99)
+    printf("TEST%u: Test bulk append\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test bulk append\t\t[FAILURE]\n", ++t);
+
+  // Test using an array as a ring buffer queue
+  struct array *array8 = array_create_inline(16, sizeof(int));
+  int next = 0, expect = 0;
+  success = 1;
+
+  for(int round = 0; round < 10; round++) {
+    for(int i = 0; i < 12; i++)
+      array_append(array8, &next, sizeof(int)), next++;
+
+    while(array_size(array8)) {
+      if(*(int*)array_pop_beg(array8) != expect++)
+        success = 0;
+    }
+  }
+
+  if(success && array8->capacity == 16)
+    printf("TEST%u: Test drain and refill queue\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test drain and refill queue\t[FAILURE]\n", ++t);
+
+  // Test pushing to the front of a wrapped array
+  for(int i = 6; i < 12; i++)
+    array_append(array8, &i, sizeof(int));
+
+  for(int i = 5; i >= 0; i--)
+    array_prepend(array8, &i, sizeof(int));
+
+  if(array8->head + array_size(array8) <= array8->capacity || *(int*)array_pop_pos(array8, 3) != 3)
+    success = 0;
+
+  int three = 3;
+  array_insert(array8, 3, &three, sizeof(int));
+
+  for(int i = 12; i < 30; i++)
+    array_append(array8, &i, sizeof(int));
+
+  for(int i = 0; i < 30; i++) {
+    if(*(int*)array_get(array8, i) != i)
+      success = 0;
+  }
+
+  if(success && array_size(array8) == 30)
+    printf("TEST%u: Test push front of ring\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test push front of ring\t[FAILURE]\n", ++t);
+
+  array_print_int(array8, 10);
+
+  // Test handing blocks to arrays without copying
+  struct array *array9  = array_create(0);
+  struct array *array10 = array_create_view(0);
+  int *block = malloc(sizeof(int) * 2);
+  block[0] = 1; block[1] = 2;
+
+  success  = array_push_ptr(array9, block);
+  success += array_adopt(array9, 0, malloc(sizeof(int)));
+
+  if(success == 2 && array_get(array9, 1) == block && !array_adopt(array8, 0, block))
+    printf("TEST%u: Test adopt pointers\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test adopt pointers\t\t[FAILURE]\n", ++t);
+
+  // Test borrowing pointers in a view
+  success  = array_copy_from(array10, array9, 0);
+  success += array_append(array10, temp1, sizeof(char) * 11);
+
+  if(success == 2 && array_get(array10, 1) == block && array_get(array10, 2) == temp1
+    && !array_copy_from(array1, array9, 0))
+    printf("TEST%u: Test view borrows pointers\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test view borrows pointers\t[FAILURE]\n", ++t);
+
+  // Test a threaded sort of inline pairs keeps equal keys in order
+  struct array *array11 = array_create_inline(0, sizeof(size_t) * 2);
+  int sorted            = 1;
+
+  for(size_t i = 0; i < 50000; i++) {
+    size_t pair[2] = { (i * 7919) % 1000, i };
+    array_append(array11, pair, sizeof(pair));
+  }
+
+  array_pop_beg(array11); // Start the ring off at an offset
+  success = array_sort(array11, compare_key, 4);
+
+  for(size_t i = 1; i < array_size(array11); i++) {
+    size_t *prev = array_get(array11, i - 1), *pair = array_get(array11, i);
+
+    if(prev[0] > pair[0] || (prev[0] == pair[0] && prev[1] > pair[1]))
+      sorted = 0;
+  }
+
+  if(success && sorted && array_size(array11) == 49999)
+    printf("TEST%u: Test threaded stable sort\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test threaded stable sort\t[FAILURE]\n", ++t);
+
+  // Test sorting pointer elements by the data they point at
+  struct array *array12 = array_create(0);
+  const char *words[5]  = { "pear", "apple", "fig", "plum", "date" };
+
+  for(size_t i = 0; i < 5; i++)
+    array_append(array12, (void*)words[i], strlen(words[i]) + 1);
+
+  success = array_sort(array12, compare_string, 1);
+
+  if(success && !strcmp(array_front(array12), "apple") && !strcmp(array_get(array12, 2), "fig")
+    && !strcmp(array_back(array12), "plum"))
+    printf("TEST%u: Test sort pointers\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test sort pointers\t\t[FAILURE]\n", ++t);
+
+  // Test a parallel loop reaches every element of a wrapped array
+  struct array *array13 = array_create_inline(0, sizeof(size_t));
+  size_t sum            = 0;
+
+  for(size_t i = 0; i <= 50000; i++)
+    array_append(array13, &i, sizeof(size_t));
+
+  array_pop_beg(array13); // Start the ring off at an offset
+  success = array_parallel_for_each(array13, square_key, NULL, 4);
+
+  for(size_t i = 0; success && i < 50000; i++)
+    success = *(size_t*)array_get(array13, i) == (i + 1) * (i + 1);
+
+  if(success)
+    printf("TEST%u: Test parallel for each\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test parallel for each\t[FAILURE]\n", ++t);
+
+  // Test a parallel map and reduce sums the squares
+  success = array_parallel_reduce(array13, sum_map, sum_reduce, NULL, &sum, sizeof(size_t), 4);
+
+  if(success && sum == (size_t)50000 * 50001 * 100001 / 6)
+    printf("TEST%u: Test parallel reduce\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test parallel reduce\t[FAILURE]\n", ++t);
+
+  // Test the stats counters are only kept when built in
+  struct struct_stats stats;
+#ifdef STATS_BUILD
+  success = array_stats(array4, &stats) && stats.moves > 0 && stats.allocs >= 30;
+#else
+  success = !array_stats(array4, &stats) && stats.moves == 0;
+#endif
+
+  if(success)
+    printf("TEST%u: Test array stats\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test array stats\t\t[FAILURE]\n", ++t);
+
   // Test the freeing of dynamically added memory
   array_free(array1);
   array_free(array2);
   array_free(array3);
   array_free(array4);
+  array_free(array5);
+  array_free(array6);
+  array_free(array7);
+  array_free(array8);
+  array_free(array9);
+  array_free(array10);
+  array_free(array11);
+  array_free(array12);
+  array_free(array13);
+}
+
+
+void hist_tests() {
+  printf("|---------- HIST STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test percentiles of a uniform spread of values
+  struct hist *hist1 = hist_create(1);
+
+  for(size_t i = 1; i <= 10000; i++)
+    hist_record(hist1, i);
+
+  size_t p50 = hist_percentile(hist1, 50.0);
+  size_t p99 = hist_percentile(hist1, 99.0);
+
+  if(p50 >= 5000 && p50 <= 5000 + 5000 / HIST_SUB && p99 >= 9900 && p99 <= 9900 + 9900 / HIST_SUB
+    && hist_percentile(hist1, 100.0) == 10000)
+    printf("TEST%u: Histogram percentiles\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Histogram percentiles\t[FAILURE]\n", ++t);
+
+  // Test timing a heap with sampling
+  struct hist *hist2 = hist_create(1);
+  struct hist *hist3 = hist_create(10);
+  struct heap *heap1 = heap_create(MINHEAP);
+
+  heap_attach_hist(heap1, hist2, hist3);
+
+  for(size_t i = 0; i < 1000; i++)
+    heap_add(heap1, &i, 1000 - i, sizeof(size_t));
+
+  for(size_t i = 0; i < 1000; i++)
+    heap_free_elem(heap_pop(heap1));
+
+  if(hist_count(hist2) == 1000 && hist_count(hist3) == 100)
+    printf("TEST%u: Heap latency histograms\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Heap latency histograms\t[FAILURE]\n", ++t);
+
+  hist_print(hist2, "\theap_add");
+  hist_print(hist3, "\theap_pop");
+
+  // Test elems popped in a batch are sampled one by one
+  struct elem popped[100];
+
+  for(size_t i = 0; i < 100; i++)
+    heap_add(heap1, &i, i, sizeof(size_t));
+
+  size_t count = heap_pop_n(heap1, popped, 100);
+
+  for(size_t i = 0; i < count; i++)
+    free(popped[i].data);
+
+  if(count == 100 && hist_count(hist3) == 110)
+    printf("TEST%u: Batch pops are sampled\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Batch pops are sampled\t[FAILURE]\n", ++t);
+
+  heap_free(heap1);
+  hist_free(hist1);
+  hist_free(hist2);
+  hist_free(hist3);
 }
 
 
@@ -321,23 +899,1059 @@ void heap_tests() {
   else
     printf("TEST%u: Invalid pop from heap\t[FAILURE]\n", ++t);
 
-  // Test the freeing of heap memory
-  heap_free(heap1);
-  heap_free(heap2);
-  heap_free(heap3);
-}
+  // Test popping into caller owned storage
+  struct heap *heap4 = heap_create(MAXHEAP);
+  struct elem elem;
 
+  for(size_t i = 0; i < 10; i++)
+    heap_add(heap4, &temp1[i], i * 3 % 10, sizeof(char));
 
-/////////////////////////////////////////////////////////////
-// MAIN FUNCTION IMPLEMENTATION
-//
+  if(heap_pop_into(heap4, &elem) && elem.value == 9 && *(char*)elem.data == '3'
+    && heap_size(heap4) == 9 && heap_get_value(heap4, 0) == 8)
+    printf("TEST%u: Pop into elem from heap\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Pop into elem from heap\t[FAILURE]\n", ++t);
 
-int main(const int argc, const char *argv[]) {
-  // Function to run the array struct tests
-  array_tests();
+  free(elem.data);
 
-  // Function to run the heap struct tests
-  heap_tests();
+  // Test that the dense keys stay parallel to the elems
+  int success = 1;
+
+  for(size_t i = 0; i < heap_size(heap4); i++) {
+    if(heap_get_value(heap4, i) != ((struct elem*)array_get(heap4->array, i))->value)
+      success = 0;
+  }
+
+  if(success && array_size(heap4->keys) == heap_size(heap4))
+    printf("TEST%u: Keys mirror elem values\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Keys mirror elem values\t[FAILURE]\n", ++t);
+
+  // Test that wider heaps pop in order
+  size_t arity[3] = { 2, 4, 8 };
+
+  for(size_t a = 0; a < 3; a++) {
+    struct heap *heap5 = heap_create_ary(MINHEAP, arity[a], NULL);
+    size_t last = 0;
+    success = 1;
+
+    for(size_t i = 0; i < 500; i++)
+      heap_add(heap5, &i, (i * 7919) % 1000, sizeof(size_t));
+
+    while(heap_size(heap5)) {
+      heap_pop_into(heap5, &elem);
+
+      if(elem.value < last)
+        success = 0;
+
+      last = elem.value;
+      free(elem.data);
+    }
+
+    if(success)
+      printf("TEST%u: Pop %zu-ary heap in order\t[SUCCESS]\n", ++t, arity[a]);
+    else
+      printf("TEST%u: Pop %zu-ary heap in order\t[FAILURE]\n", ++t, arity[a]);
+
+    heap_free(heap5);
+  }
+
+  // Test building a heap from an array of elems
+  struct array *array1 = array_create_inline(0, sizeof(struct elem));
+  struct array *array2 = array_create(0);
+
+  for(size_t i = 0; i < 100; i++) {
+    struct elem build = { malloc(sizeof(size_t)), sizeof(size_t), (i * 37) % 100 };
+    *(size_t*)build.data = build.value;
+    array_append(array1, &build, sizeof(struct elem));
+
+    build.data = malloc(sizeof(size_t));
+    *(size_t*)build.data = build.value;
+    array_append(array2, &build, sizeof(struct elem));
+  }
+
+  struct heap *heap7 = heap_from_array(MAXHEAP, array1);
+  struct heap *heap8 = heap_from_array(MINHEAP, array2);
+  success = (heap7 && heap8 && heap_size(heap7) == 100 && heap_size(heap8) == 100);
+
+  for(size_t i = 0; success && i < 100; i++) {
+    struct elem max, min;
+    heap_pop_into(heap7, &max);
+    heap_pop_into(heap8, &min);
+
+    if(max.value != 99 - i || *(size_t*)max.data != max.value || min.value != i)
+      success = 0;
+
+    free(max.data);
+    free(min.data);
+  }
+
+  if(success)
+    printf("TEST%u: Build heap from array\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Build heap from array\t[FAILURE]\n", ++t);
+
+  heap_free(heap7);
+  heap_free(heap8);
+
+  // Test updating and removing elems through handles
+  struct heap *heap9 = heap_create_ary(MINHEAP, 4, NULL);
+  size_t handles[100];
+  success = 1;
+
+  for(size_t i = 0; i < 100; i++)
+    success &= heap_add_handle(heap9, &i, 1000 + i, sizeof(size_t), &handles[i]);
+
+  // Pull the odd elems to the front and drop every tenth
+  for(size_t i = 1; i < 100; i += 2)
+    success &= heap_update_key(heap9, handles[i], i);
+
+  for(size_t i = 0; i < 100; i += 10)
+    success &= heap_remove(heap9, handles[i], NULL);
+
+  if(heap_handle_index(heap9, handles[0]) != HEAP_NONE || heap_remove(heap9, handles[0], NULL))
+    success = 0;
+
+  for(size_t i = 1; success && i < 100; i += 2) {
+    heap_pop_into(heap9, &elem);
+
+    if(elem.value != i || *(size_t*)elem.data != i)
+      success = 0;
+
+    free(elem.data);
+  }
+
+  // Batches cannot be given handles so heaps tracking them refuse one
+  struct elem one = { &handles[0], sizeof(size_t), 0 };
+  success         = success && !heap_add_n(heap9, &one, 1);
+
+  if(success && heap_size(heap9) == 40 && heap_get_value(heap9, 0) == 1002)
+    printf("TEST%u: Update and remove by handle\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Update and remove by handle\t[FAILURE]\n", ++t);
+
+
+  // Test batches of adds and pops against single ones
+  struct heap *heap11 = heap_create_ary(MINHEAP, 4, NULL);
+  struct elem batch[300];
+  size_t keys[300];
+
+  for(size_t i = 0; i < 300; i++) {
+    keys[i]  = (i * 7919) % 300;
+    batch[i] = (struct elem){ &keys[i], sizeof(size_t), keys[i] };
+  }
+
+  // A small batch is sifted in and a large one rebuilt
+  success  = heap_add_n(heap11, batch, 250);
+  success += heap_add_n(heap11, batch + 250, 50);
+  success += heap_add_n(heap11, NULL, 0);
+
+  size_t popped = heap_pop_n(heap11, batch, 200);
+  popped       += heap_pop_n(heap11, batch + 200, 200);
+
+  for(size_t i = 0; success == 3 && i < 300; i++) {
+    if(batch[i].value != i || *(size_t*)batch[i].data != i)
+      success = 0;
+
+    free(batch[i].data);
+  }
+
+  if(success == 3 && popped == 300 && heap_size(heap11) == 0)
+    printf("TEST%u: Batched add and pop\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Batched add and pop\t[FAILURE]\n", ++t);
+
+  // Test a bounded heap keeps the largest values of a stream
+  struct heap *heap10 = heap_create_bounded(MINHEAP, 10);
+  struct elem top[10];
+  size_t handle       = 0;
+  size_t kept         = 0;
+
+  for(size_t i = 0; i < 1000; i++) {
+    size_t value = (i * 7919) % 1000;
+    kept        += heap_offer(heap10, &value, value, sizeof(size_t)) == H_OK;
+  }
+
+  // The heap never grows past the room reserved for it
+  success = heap_size(heap10) == 10 && heap10->array->capacity == 10 && kept < 1000
+    && heap_offer(heap10, &handle, 0, sizeof(size_t)) == H_REJECT
+    && !heap_add_handle(heap10, &handle, 0, sizeof(size_t), &handle);
+
+  success = success && heap_drain_sorted(heap10, top) == 10 && heap_size(heap10) == 0;
+
+  for(size_t i = 0; success && i < 10; i++)
+    success = top[i].value == 999 - i && *(size_t*)top[i].data == top[i].value;
+
+  if(success)
+    printf("TEST%u: Bounded top-k heap\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Bounded top-k heap\t[FAILURE]\n", ++t);
+
+  for(size_t i = 0; i < 10; i++)
+    free(top[i].data);
+
+  heap_free(heap10);
+
+  // Test payloads of one rounded size keep reusing the root's block
+  struct heap *heap16 = heap_create_bounded(MINHEAP, 1);
+  char text[32]       = "a payload of thirty bytes long";
+
+  heap_offer(heap16, text, 1, 30);
+  void *block = heap_peek_min(heap16)->data;
+
+  success  = heap_offer(heap16, text, 2, 20) == H_OK && heap_peek_min(heap16)->data == block;
+  success += heap_offer(heap16, text, 3, 30) == H_OK && heap_peek_min(heap16)->data == block;
+
+  if(success == 2 && heap_peek_min(heap16)->size == 30 && !memcmp(heap_peek_min(heap16)->data, text, 30))
+    printf("TEST%u: Bounded heap reuses blocks\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Bounded heap reuses blocks\t[FAILURE]\n", ++t);
+
+  heap_free(heap16);
+
+  // Test a small heap keeps short payloads in its elems
+  struct heap *heap12 = heap_create_small(MINHEAP);
+  char word[]         = "not inline";
+
+  for(size_t i = 0; i < 10; i++)
+    heap_add(heap12, &temp1[i], 10 - i, sizeof(char));
+
+  heap_add(heap12, word, 0, sizeof(word));
+  heap_add(heap12, word, 20, sizeof(word));
+
+  // Small and normal heaps release payloads differently so cannot merge
+  success = heap_size(heap12) == 12 && !heap_merge(heap12, heap1);
+
+  for(size_t i = 0; success && i < 11; i++) {
+    struct elem *elem = heap_pop(heap12);
+    char *data        = heap_elem_data(heap12, elem);
+
+    if(i == 0)
+      success = elem->data != word && strcmp(data, word) == 0;
+    else
+      success = data == (char*)&elem->data && *data == temp1[10 - i];
+
+    heap_release_elem(heap12, elem);
+  }
+
+  if(success)
+    printf("TEST%u: Small payloads inline\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Small payloads inline\t[FAILURE]\n", ++t);
+
+  heap_free(heap12);
+
+  // Test a parallel loop visits every elem of a heap
+  struct heap *heap13 = heap_create(MINHEAP);
+  atomic_size_t total;
+  atomic_init(&total, 0);
+
+  for(size_t i = 0; i < 5000; i++)
+    heap_add(heap13, &i, i, sizeof(size_t));
+
+  if(heap_parallel_for_each(heap13, sum_elem, &total, 4) && atomic_load(&total) == (size_t)4999 * 5000 / 2)
+    printf("TEST%u: Parallel for each elem\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Parallel for each elem\t[FAILURE]\n", ++t);
+
+  heap_free(heap13);
+
+  // Test a min-max heap serves both ends after updates and removals
+  struct heap *heap14 = heap_create(MINMAXHEAP);
+  size_t ids[1000];
+  size_t expected     = 0;
+
+  for(size_t i = 0; i < 1000; i++) {
+    size_t value = (i * 7919) % 1000;
+    heap_add_handle(heap14, &value, value, sizeof(size_t), &ids[value]);
+    expected += value;
+  }
+
+  success  = heap_update_key(heap14, ids[500], 2000);
+  success += heap_update_key(heap14, ids[10], 0);
+  success += heap_remove(heap14, ids[999], NULL);
+  success += heap_remove(heap14, ids[0], NULL);
+  expected = expected + 1500 - 10 - 999;
+
+  success = success == 4 && heap_peek_min(heap14)->value == 0 && heap_peek_max(heap14)->value == 2000;
+
+  // Pop from alternate ends until the two meet
+  size_t low = 0, high = (size_t)-1, sum = 0, pops = 0;
+
+  while(success && heap_size(heap14)) {
+    struct elem elem;
+
+    if(pops++ % 2) {
+      success = heap_pop_max(heap14, &elem) && elem.value <= high && elem.value >= low;
+      high    = elem.value;
+    } else {
+      success = heap_pop_min(heap14, &elem) && elem.value >= low && elem.value <= high;
+      low     = elem.value;
+    }
+
+    sum += elem.value;
+    free(elem.data);
+  }
+
+  // Min-max heaps are binary and other heaps only keep one end
+  heap_add(heap14, &low, 1, sizeof(size_t));
+  heap_add(heap14, &low, 2, sizeof(size_t));
+  heap_add(heap11, &low, 0, sizeof(size_t));
+  heap_add(heap11, &low, 1, sizeof(size_t));
+
+  success = success && pops == 998 && sum == expected && !heap_create_ary(MINMAXHEAP, 4, NULL)
+    && heap_peek_max(heap14)->value == 2 && heap_peek_min(heap14)->value == 1
+    && !heap_peek_max(heap11) && heap_peek_min(heap11)->value == 0;
+
+  if(success)
+    printf("TEST%u: Min-max heap both ends\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Min-max heap both ends\t[FAILURE]\n", ++t);
+
+  heap_free(heap11);
+  heap_free(heap14);
+
+  // Test a min-max heap built from a batch drains in order
+  struct heap *heap15 = heap_create(MINMAXHEAP);
+
+  for(size_t i = 0; i < 300; i++) {
+    keys[i]  = (i * 7919) % 300;
+    batch[i] = (struct elem){ &keys[i], sizeof(size_t), keys[i] };
+  }
+
+  success = heap_add_n(heap15, batch, 300) && heap_drain_sorted(heap15, batch) == 300;
+
+  for(size_t i = 0; i < 300; i++) {
+    success = success && batch[i].value == 299 - i && *(size_t*)batch[i].data == batch[i].value;
+    free(batch[i].data);
+  }
+
+  if(success)
+    printf("TEST%u: Build min-max heap\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Build min-max heap\t\t[FAILURE]\n", ++t);
+
+  heap_free(heap15);
+
+  // Test the stats counters are only kept when built in
+  struct struct_stats stats;
+#ifdef STATS_BUILD
+  success = heap_stats(heap9, &stats) && stats.sifts > 0 && stats.max_sift_levels > 0;
+#else
+  success = !heap_stats(heap9, &stats) && stats.sifts == 0;
+#endif
+
+  if(success)
+    printf("TEST%u: Test heap stats\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Test heap stats\t\t[FAILURE]\n", ++t);
+
+  heap_free(heap9);
+
+  // Test print a wider heap
+  struct heap *heap6 = heap_create_ary(MAXHEAP, 4, NULL);
+
+  for(size_t i = 0; i < 10; i++)
+    heap_add(heap6, &temp1[i], i, sizeof(char));
+
+  printf("TEST%u: Print the 4-ary maxheap tree...\t\n", ++t);
+  heap_print(heap6);
+  heap_free(heap6);
+
+  // Test the freeing of heap memory
+  heap_free(heap1);
+  heap_free(heap2);
+  heap_free(heap3);
+  heap_free(heap4);
+}
+
+
+/////////////////////////////////////////////////////////////
+// MAIN FUNCTION IMPLEMENTATION
+//
+
+void pheap_tests() {
+  printf("|---------- PHEAP STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test a pairing heap pops in order and reuses its nodes
+  struct pheap *pheap1 = pheap_create(MINHEAP);
+  int ordered          = 1;
+
+  for(size_t round = 0; round < 2; round++) {
+    size_t last = 0;
+
+    for(size_t i = 0; i < 100; i++) {
+      size_t value = (i * 37) % 100;
+      pheap_add(pheap1, &value, value, sizeof(size_t));
+    }
+
+    for(size_t i = 0; i < 100; i++) {
+      struct elem *elem = pheap_pop(pheap1);
+
+      if(!elem || elem->value < last || *(size_t*)elem->data != elem->value)
+        ordered = 0;
+
+      last = elem ? elem->value : last;
+      heap_free_elem(elem);
+    }
+  }
+
+  if(ordered && pheap_size(pheap1) == 0 && !pheap_pop(pheap1))
+    printf("TEST%u: Pairing heap order\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Pairing heap order\t[FAILURE]\n", ++t);
+
+  // Test merging two pairing heaps keeps every elem in order
+  struct pheap *pheap2 = pheap_create(MAXHEAP);
+  struct pheap *pheap3 = pheap_create(MAXHEAP);
+  size_t last          = (size_t)-1;
+  ordered              = 1;
+
+  for(size_t i = 0; i < 100; i++)
+    pheap_add(i % 2 ? pheap2 : pheap3, &i, i, sizeof(size_t));
+
+  pheap_merge(pheap2, pheap3);
+  pheap_add(pheap3, &last, 1000, sizeof(size_t));
+
+  for(size_t i = 0; i < 100; i++) {
+    struct elem elem;
+
+    if(!pheap_pop_into(pheap2, &elem) || elem.value > last)
+      ordered = 0;
+
+    last = elem.value;
+    free(elem.data);
+  }
+
+  if(ordered && last == 0 && pheap_size(pheap3) == 1 && pheap_get_value(pheap3) == 1000
+    && !pheap_merge(pheap2, pheap1))
+    printf("TEST%u: Pairing heap merge\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Pairing heap merge\t[FAILURE]\n", ++t);
+
+  // Test merging array heaps by sifting and by rebuilding
+  struct heap *heap1 = heap_create_ary(MINHEAP, 4, NULL);
+  struct heap *heap2 = heap_create_ary(MINHEAP, 4, NULL);
+  struct heap *heap3 = heap_create(MINHEAP);
+  ordered            = 1;
+
+  for(size_t i = 0; i < 200; i++) {
+    size_t value = (i * 37) % 200;
+    heap_add(i < 190 ? heap1 : heap2, &value, value, sizeof(size_t));
+    heap_add(heap3, &value, value + 200, sizeof(size_t));
+  }
+
+  heap_merge(heap1, heap2);
+  heap_merge(heap1, heap3);
+
+  for(size_t i = 0; i < 400; i++) {
+    struct elem elem;
+
+    if(!heap_pop_into(heap1, &elem) || elem.value != i)
+      ordered = 0;
+
+    free(elem.data);
+  }
+
+  if(ordered && heap_size(heap2) == 0 && heap_size(heap3) == 0)
+    printf("TEST%u: Heap merge\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Heap merge\t[FAILURE]\n", ++t);
+
+  pheap_free(pheap1);
+  pheap_free(pheap2);
+  pheap_free(pheap3);
+  heap_free(heap1);
+  heap_free(heap2);
+  heap_free(heap3);
+}
+
+
+void pool_tests() {
+  printf("|---------- POOL STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test every chunk of a job runs exactly once
+  struct pool *pool = pool_create(4);
+  atomic_size_t counts[101];
+  int success       = 1;
+
+  for(size_t i = 0; i < 101; i++)
+    atomic_init(&counts[i], 0);
+
+  // Run the job several times on the same workers
+  for(size_t r = 0; r < 10; r++)
+    success = success && pool_run(pool, pool_count, counts, 100, 4);
+
+  for(size_t i = 1; success && i < 101; i++)
+    success = atomic_load(&counts[i]) == 10;
+
+  if(success && atomic_load(&counts[0]) == 10 * 4950 && pool_size(pool) == 3)
+    printf("TEST%u: Run chunks on a pool\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Run chunks on a pool\t\t[FAILURE]\n", ++t);
+
+  // Test a job posted from inside a task runs on its caller
+  void *nested[2] = { pool, counts };
+  atomic_store(&counts[0], 0);
+  atomic_store(&counts[1], 0);
+  atomic_store(&counts[2], 0);
+
+  success = pool_run(pool, pool_nested, nested, 8, 4) && atomic_load(&counts[1]) == 8
+    && atomic_load(&counts[2]) == 8;
+
+  if(success && !pool_run(pool, NULL, NULL, 1, 1) && pool_shared() == pool_shared())
+    printf("TEST%u: Nested jobs on a pool\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Nested jobs on a pool\t\t[FAILURE]\n", ++t);
+
+  // Test the shared pool can be torn down and made again
+  for(size_t i = 0; i < 5; i++)
+    atomic_store(&counts[i], 0);
+
+  pool_shared_free();
+  success = pool_run(pool_shared(), pool_count, counts, 4, 4);
+
+  for(size_t i = 1; success && i < 5; i++)
+    success = atomic_load(&counts[i]) == 1;
+
+  if(success)
+    printf("TEST%u: Free the shared pool\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Free the shared pool\t\t[FAILURE]\n", ++t);
+
+  pool_free(pool);
+
+  // Test workers started for a job take their seats in it
+  struct pool_spread spread;
+  pthread_mutex_init(&spread.lock, NULL);
+  spread.count = 0;
+
+  pool    = pool_create(1);
+  success = pool && pool_size(pool) == 0 && pool_run(pool, pool_spread, &spread, 8, 4);
+
+  if(success && spread.count > 1 && pool_size(pool) == 3)
+    printf("TEST%u: Grow a pool for a job\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Grow a pool for a job\t\t[FAILURE]\n", ++t);
+
+  pthread_mutex_destroy(&spread.lock);
+  pool_free(pool);
+}
+
+
+void pqueue_tests() {
+  printf("|---------- PQUEUE STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test a strict queue pops in order across shards
+  struct pqueue *queue1 = pqueue_create(MINHEAP, 4, P_STRICT);
+  int ordered           = 1;
+  size_t last           = 0;
+
+  for(size_t i = 0; i < 100; i++) {
+    size_t value = (i * 37) % 100;
+    pqueue_add(queue1, &value, value, sizeof(size_t));
+  }
+
+  for(size_t i = 0; i < 100; i++) {
+    struct elem *elem = pqueue_pop(queue1);
+
+    if(!elem || elem->value < last || *(size_t*)elem->data != elem->value)
+      ordered = 0;
+
+    last = elem ? elem->value : last;
+    heap_free_elem(elem);
+  }
+
+  if(ordered && pqueue_size(queue1) == 0 && !pqueue_pop(queue1))
+    printf("TEST%u: Strict pqueue order\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Strict pqueue order\t[FAILURE]\n", ++t);
+
+  // Test both modes keep every elem with several threads
+  int modes[2]         = { P_STRICT, P_RELAXED };
+  const char *names[2] = { "Strict", "Relaxed" };
+
+  for(size_t m = 0; m < 2; m++) {
+    struct pqueue *queue2 = pqueue_create(MAXHEAP, 8, modes[m]);
+    pthread_t threads[4];
+
+    for(size_t i = 0; i < 4; i++)
+      pthread_create(&threads[i], NULL, pqueue_worker, queue2);
+
+    for(size_t i = 0; i < 4; i++)
+      pthread_join(threads[i], NULL);
+
+    size_t size    = pqueue_size(queue2);
+    size_t drained = 0;
+    struct elem elem;
+
+    while(pqueue_pop_into(queue2, &elem)) {
+      free(elem.data);
+      ++drained;
+    }
+
+    if(size == 2000 && drained == 2000)
+      printf("TEST%u: %s pqueue threads\t[SUCCESS]\n", ++t, names[m]);
+    else
+      printf("TEST%u: %s pqueue threads\t[FAILURE]\n", ++t, names[m]);
+
+    pqueue_free(queue2);
+  }
+
+  pqueue_free(queue1);
+}
+
+
+void queue_tests() {
+  printf("|---------- QUEUE STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test the queue is first in first out and bounded
+  struct queue *queue1 = queue_create(5);
+  size_t items[8]      = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  size_t pushed        = 0;
+
+  while(queue_push(queue1, &items[pushed]))
+    ++pushed;
+
+  if(pushed == 8 && queue_capacity(queue1) == 8 && queue_size(queue1) == 8)
+    printf("TEST%u: Queue bounded push\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Queue bounded push\t[FAILURE]\n", ++t);
+
+  // Test wrapping around the ring keeps the order
+  int ordered = 1;
+
+  for(size_t i = 0; i < 20; i++) {
+    size_t *item = queue_pop(queue1);
+
+    if(!item || *item != i % 8 || !queue_push(queue1, item))
+      ordered = 0;
+  }
+
+  for(size_t i = 0; i < 8; i++)
+    queue_pop(queue1);
+
+  if(ordered && queue_size(queue1) == 0 && !queue_pop(queue1) && !queue_push(queue1, NULL))
+    printf("TEST%u: Queue order and wrap\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Queue order and wrap\t[FAILURE]\n", ++t);
+
+  // Test several producers and consumers hand over every item
+  struct queue *queue2 = queue_create(64);
+  pthread_t producers[2], consumers[2];
+  size_t stop          = 0;
+  size_t total         = 0;
+  void *result         = NULL;
+  void *produced[2];
+
+  for(size_t i = 0; i < 2; i++) {
+    pthread_create(&producers[i], NULL, queue_producer, queue2);
+    pthread_create(&consumers[i], NULL, queue_consumer, queue2);
+  }
+
+  for(size_t i = 0; i < 2; i++)
+    pthread_join(producers[i], &produced[i]);
+
+  // Wait to push the markers until the items have all been pushed
+  for(size_t i = 0; i < 2; i++) {
+    while(!queue_push(queue2, &stop))
+      sched_yield();
+  }
+
+  for(size_t i = 0; i < 2; i++) {
+    pthread_join(consumers[i], &result);
+    total += *(size_t*)result;
+    free(result);
+  }
+
+  // The items can only go once no consumer can still be reading them
+  for(size_t i = 0; i < 2; i++)
+    free(produced[i]);
+
+  if(total == 2 * (10000 * 10001 / 2))
+    printf("TEST%u: Queue threads\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Queue threads\t[FAILURE]\n", ++t);
+
+  queue_free(queue1);
+  queue_free(queue2);
+}
+
+
+void radix_tests() {
+  printf("|---------- RADIX STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test values come out in order as in a min-heap
+  struct radix *radix1 = radix_create();
+  int ordered          = 1;
+  size_t last          = 0;
+
+  for(size_t i = 0; i < 100; i++) {
+    size_t value = (i * 37) % 100;
+    radix_add(radix1, &value, value, sizeof(size_t));
+  }
+
+  for(size_t i = 0; i < 100; i++) {
+    struct elem *elem = radix_pop(radix1);
+
+    if(!elem || elem->value < last || *(size_t*)elem->data != elem->value)
+      ordered = 0;
+
+    last = elem ? elem->value : last;
+    heap_free_elem(elem);
+  }
+
+  if(ordered && radix_size(radix1) == 0 && !radix_pop(radix1))
+    printf("TEST%u: Radix order\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Radix order\t[FAILURE]\n", ++t);
+
+  // Test a monotone workload matches a heap and rejects smaller values
+  struct radix *radix2 = radix_create();
+  struct heap *heap1   = heap_create(MINHEAP);
+  size_t seed          = 12345;
+  int matched          = 1;
+  struct elem relem, helem;
+
+  for(size_t i = 0; i < 1000; i++) {
+    radix_add(radix2, &i, i * 7 % 1000, sizeof(size_t));
+    heap_add(heap1, &i, i * 7 % 1000, sizeof(size_t));
+  }
+
+  for(size_t i = 0; i < 5000; i++) {
+    if(!radix_pop_into(radix2, &relem) || !heap_pop_into(heap1, &helem) || relem.value != helem.value)
+      matched = 0;
+
+    seed         = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    size_t value = helem.value + (seed >> 33) % 1000000;
+
+    radix_add(radix2, &value, value, sizeof(size_t));
+    heap_add(heap1, &value, value, sizeof(size_t));
+    free(relem.data);
+    free(helem.data);
+  }
+
+  if(matched && radix_get_value(radix2) == heap_get_value(heap1, 0)
+    && !radix_add(radix2, &seed, radix_get_value(radix2) - 1, sizeof(size_t)))
+    printf("TEST%u: Radix monotone workload\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Radix monotone workload\t[FAILURE]\n", ++t);
+
+  radix_free(radix1);
+  radix_free(radix2);
+  heap_free(heap1);
+}
+
+
+void store_tests() {
+  printf("|---------- STORE STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test an inline array is mapped back in place
+  struct array *array1 = array_create_inline(0, sizeof(size_t));
+
+  for(size_t i = 0; i < 1001; i++)
+    array_append(array1, &i, sizeof(size_t));
+
+  array_pop_beg(array1); // Save a ring that does not start at zero
+
+  int success          = array_save(array1, "structs_store.bin", NULL);
+  struct store *store1 = store_open("structs_store.bin");
+  struct array *array2 = array_load(store1);
+  int matched          = array2 && (array2->flags & A_MAPPED) && array_size(array2) == 1000;
+
+  for(size_t i = 0; matched && i < 1000; i++)
+    matched = *(size_t*)array_get(array2, i) == i + 1;
+
+  // Growing the loaded array copies it out of the mapping
+  size_t value = 1001;
+  array_append(array2, &value, sizeof(size_t));
+
+  if(success && matched && !(array2->flags & A_MAPPED) && *(size_t*)array_back(array2) == 1001)
+    printf("TEST%u: Store inline array\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store inline array\t[FAILURE]\n", ++t);
+
+  array_free(array2);
+  store_close(store1);
+
+  // Test pointer arrays need sizes and reload their payloads
+  struct array *array3 = array_create(0);
+  const char *words[3] = { "alpha", "beta", "gamma" };
+
+  for(size_t i = 0; i < 3; i++)
+    array_append(array3, (void*)words[i], strlen(words[i]) + 1);
+
+  success              = !array_save(array3, "structs_store.bin", NULL);
+  success             += array_save(array3, "structs_store.bin", string_size);
+  struct store *store2 = store_open("structs_store.bin");
+  struct array *array4 = array_load(store2);
+
+  array_append(array4, "delta", 6);
+
+  if(success == 2 && array_size(array4) == 4 && !strcmp(array_get(array4, 0), "alpha")
+    && !strcmp(array_get(array4, 2), "gamma") && !strcmp(array_back(array4), "delta"))
+    printf("TEST%u: Store pointer array\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store pointer array\t[FAILURE]\n", ++t);
+
+  array_free(array4);
+  store_close(store2);
+
+  // Test a heap is loaded in heap order and stays usable
+  struct heap *heap1 = heap_create_ary(MAXHEAP, 4, NULL);
+
+  for(size_t i = 0; i < 500; i++) {
+    size_t key = (i * 37) % 500;
+    heap_add(heap1, &key, key, sizeof(size_t));
+  }
+
+  success              = heap_save(heap1, "structs_store.bin");
+  struct store *store3 = store_open("structs_store.bin");
+  struct heap *heap2   = heap_load(store3);
+  size_t last          = 1000;
+  matched              = heap2 && heap2->arity == 4 && heap_size(heap2) == 500;
+
+  value = 750;
+  heap_add(heap2, &value, value, sizeof(size_t));
+
+  for(size_t i = 0; matched && i < 501; i++) {
+    struct elem *elem = heap_pop(heap2);
+
+    if(!elem || elem->value > last || *(size_t*)elem->data != elem->value)
+      matched = 0;
+
+    last = elem ? elem->value : last;
+    heap_release_elem(heap2, elem);
+  }
+
+  if(success && matched && last == 0)
+    printf("TEST%u: Store heap\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store heap\t\t[FAILURE]\n", ++t);
+
+  heap_free(heap1);
+  heap_free(heap2);
+  store_close(store3);
+
+  // Test a stride and count whose product wraps are refused
+  struct store_header header;
+  size_t stride = (char*)&header.stride - (char*)&header;
+  size_t count  = (char*)&header.count - (char*)&header;
+  size_t slots  = (sizeof(struct store_header) + ALLOC_ALIGN - 1) / ALLOC_ALIGN * ALLOC_ALIGN;
+
+  array_save(array1, "structs_store.bin", NULL);
+  store_patch("structs_store.bin", stride, (uint64_t)1 << 63);
+  store_patch("structs_store.bin", count, 1);
+
+  struct store *store4 = store_open("structs_store.bin");
+  success              = store4 && !array_load(store4);
+  store_close(store4);
+
+  // Test payload offsets outside the file or out of order are refused
+  array_save(array3, "structs_store.bin", string_size);
+  store_patch("structs_store.bin", slots, 1 << 20);
+
+  store4  = store_open("structs_store.bin");
+  success = success && store4 && !array_load(store4);
+  store_close(store4);
+
+  array_save(array3, "structs_store.bin", string_size);
+  store_patch("structs_store.bin", slots + sizeof(size_t) * 2, slots + sizeof(size_t) * 4);
+
+  store4  = store_open("structs_store.bin");
+  success = success && store4 && !array_load(store4);
+  store_close(store4);
+
+  if(success)
+    printf("TEST%u: Store rejects bad slots\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store rejects bad slots\t[FAILURE]\n", ++t);
+
+  // Test a payload section inside the slots or cut off by the end of
+  // the file is refused
+  size_t payload = (char*)&header.payload - (char*)&header;
+  size_t bytes   = (char*)&header.bytes - (char*)&header;
+
+  array_save(array3, "structs_store.bin", string_size);
+  store_patch("structs_store.bin", payload, slots);
+  success = store_refused("structs_store.bin");
+
+  array_save(array3, "structs_store.bin", string_size);
+  value = store_field("structs_store.bin", payload);
+  store_cut("structs_store.bin", value);
+  store_patch("structs_store.bin", bytes, value);
+  success = success && store_refused("structs_store.bin");
+
+  if(success)
+    printf("TEST%u: Store rejects cut files\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store rejects cut files\t[FAILURE]\n", ++t);
+
+  // Test heaps with changed keys, elems out of order or a payload
+  // section inside the keys are refused
+  size_t keys        = (char*)&header.keys - (char*)&header;
+  struct elem elem;
+  size_t field       = slots + ((char*)&elem.value - (char*)&elem);
+  struct heap *heap3 = heap_create(MAXHEAP);
+  struct heap *heap4 = heap_create(MINMAXHEAP);
+
+  for(size_t i = 0; i < 20; i++) {
+    heap_add(heap3, &i, i + 1, sizeof(size_t));
+    heap_add(heap4, &i, i + 1, sizeof(size_t));
+  }
+
+  heap_save(heap3, "structs_store.bin");
+  value = store_field("structs_store.bin", keys);
+  store_patch("structs_store.bin", value + 3 * sizeof(size_t), 1 << 20);
+  success = store_refused("structs_store.bin");
+
+  heap_save(heap3, "structs_store.bin");
+  store_patch("structs_store.bin", field + 5 * sizeof(struct elem), 1 << 20);
+  store_patch("structs_store.bin", value + 5 * sizeof(size_t), 1 << 20);
+  success = success && store_refused("structs_store.bin");
+
+  heap_save(heap3, "structs_store.bin");
+  store_patch("structs_store.bin", payload, value);
+  success = success && store_refused("structs_store.bin");
+
+  // The root of a min-max heap must not exceed the max below it
+  heap_save(heap4, "structs_store.bin");
+  value = store_field("structs_store.bin", keys);
+  store_patch("structs_store.bin", field + sizeof(struct elem), 0);
+  store_patch("structs_store.bin", value + sizeof(size_t), 0);
+  success = success && store_refused("structs_store.bin");
+
+  if(success)
+    printf("TEST%u: Store rejects bad heaps\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store rejects bad heaps\t[FAILURE]\n", ++t);
+
+  heap_free(heap3);
+  heap_free(heap4);
+
+  // Test files that are not stores are refused
+  FILE *file = fopen("structs_store.bin", "wb");
+  fwrite(words[0], 1, 5, file);
+  fclose(file);
+
+  if(!store_open("structs_store.bin") && !store_open(NULL))
+    printf("TEST%u: Store rejects bad files\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Store rejects bad files\t[FAILURE]\n", ++t);
+
+  array_free(array1);
+  array_free(array3);
+  remove("structs_store.bin");
+}
+
+
+void typed_tests() {
+  printf("|---------- TYPED STRUCT TESTS ----------|\n");
+  unsigned int t = 0;
+
+  // Test a typed array stores ints by value
+  struct int_array *array1 = int_array_create(0);
+  int success              = 1;
+
+  for(int i = 0; i < 1000; i++)
+    success = success && int_array_append(array1, i * 2);
+
+  int value = 0;
+  success   = success && int_array_set(array1, 10, -1) && !int_array_set(array1, 1000, -1);
+
+  if(success && int_array_size(array1) == 1000 && int_array_get(array1, 999) == 1998
+    && *int_array_at(array1, 10) == -1 && !int_array_at(array1, 1000)
+    && int_array_pop_end(array1, &value) && value == 1998)
+    printf("TEST%u: Typed int array\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Typed int array\t\t[FAILURE]\n", ++t);
+
+  // Test a typed min-heap pops keys in order
+  struct key_heap *heap1 = key_heap_create(0);
+  size_t key             = 0;
+
+  for(size_t i = 0; i < 1000; i++)
+    key_heap_add(heap1, (i * 7919) % 1000);
+
+  for(size_t i = 0; success && i < 1000; i++)
+    success = key_heap_pop(heap1, &key) && key == i;
+
+  if(success && key_heap_size(heap1) == 0 && !key_heap_pop(heap1, &key) && !key_heap_top(heap1, &key))
+    printf("TEST%u: Typed key heap\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Typed key heap\t\t[FAILURE]\n", ++t);
+
+  // Test a typed heap ordered by a comparator function
+  struct word_heap *heap2 = word_heap_create(4);
+  const char *words[5]    = { "pear", "apple", "fig", "plum", "date" };
+  const char *word        = NULL;
+
+  for(size_t i = 0; i < 5; i++)
+    word_heap_add(heap2, words[i]);
+
+  success = word_heap_top(heap2, &word) && !strcmp(word, "plum") && word_heap_pop(heap2, &word)
+    && word_heap_pop(heap2, &word);
+
+  if(success && !strcmp(word, "pear") && word_heap_size(heap2) == 3)
+    printf("TEST%u: Typed word heap\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Typed word heap\t\t[FAILURE]\n", ++t);
+
+  // Test the checked accessors fail on an empty array
+  struct int_array *array2 = int_array_create(0);
+
+  if(!int_array_pop_end(array2, &value) && !int_array_set(array2, 0, 1) && !int_array_at(array2, 0))
+    printf("TEST%u: Typed empty array\t\t[SUCCESS]\n", ++t);
+  else
+    printf("TEST%u: Typed empty array\t\t[FAILURE]\n", ++t);
+
+  int_array_free(array2);
+
+  int_array_free(array1);
+  key_heap_free(heap1);
+  word_heap_free(heap2);
+}
+
+
+int main(const int argc, const char *argv[]) {
+  // Function to run the allocator tests
+  alloc_tests();
+
+  // Function to run the array struct tests
+  array_tests();
+
+  // Function to run the heap struct tests
+  heap_tests();
+
+  // Function to run the pairing heap tests
+  pheap_tests();
+
+  // Function to run the histogram tests
+  hist_tests();
+
+  // Function to run the thread pool tests
+  pool_tests();
+
+  // Function to run the pqueue tests
+  pqueue_tests();
+
+  // Function to run the queue tests
+  queue_tests();
+
+  // Function to run the radix heap tests
+  radix_tests();
+
+  // Function to run the store tests
+  store_tests();
+
+  // Function to run the typed macro tests
+  typed_tests();
 
   return 0;
 }